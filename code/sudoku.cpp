@@ -4,6 +4,9 @@
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <climits>
 #include <fstream>
 #include <map>
 #include <string.h>
@@ -11,527 +14,4602 @@
 #include <algorithm>
 #include <numeric>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <signal.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 using namespace std;
 
-typedef vector<vector<char> > Board;
+const int N = 9;
+
+// PCG32棺״ֻ̬64λֺɵĴ۶ԶСmt19937
+// UniformRandomBitGeneratorҪ󣬿ֱshuffle
+class Pcg32
+{
+private:
+    uint64_t state;
+    uint64_t inc; // ţͬʹͬҲص
+
+public:
+    typedef uint32_t result_type;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    explicit Pcg32(uint64_t s = 0, uint64_t stream = 0)
+    {
+        seed(s, stream);
+    }
+
+    void seed(uint64_t s, uint64_t stream = 0)
+    {
+        state = 0;
+        inc = (stream << 1) | 1;
+        (*this)();
+        state += s;
+        (*this)();
+    }
+
+    result_type operator()()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // [0, n)Χڵó˷ȡģ
+    uint32_t below(uint32_t n)
+    {
+        return (uint32_t)(((uint64_t)(*this)() * n) >> 32);
+    }
+};
+
+// ͳƣĬãʱSUDOKU_STATSΪ0ȫȥͳƴ룬ʱSolveStatsиʼΪ0
+#ifndef SUDOKU_STATS
+#define SUDOKU_STATS 1
+#endif
+#if SUDOKU_STATS
+#define STAT(...) __VA_ARGS__
+#else
+#define STAT(...)
+#endif
+
+// һλ⣨ɣۼƵĹ
+struct SolveStats
+{
+    uint64_t nodes;        // ʵڵ
+    uint64_t backtracks;   // ìܶ˵Ĵ
+    uint64_t propagations; // Լĸ
+    int maxDepth;          // 
+    double seconds;        // ʱ룩
+
+    SolveStats()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        nodes = backtracks = propagations = 0;
+        maxDepth = 0;
+        seconds = 0;
+    }
+
+    // ۼһֹͳƣͬһֺ̱ڲͬ߳ĸ
+    void add(const SolveStats &other)
+    {
+        nodes += other.nodes;
+        backtracks += other.backtracks;
+        propagations += other.propagations;
+        maxDepth = max(maxDepth, other.maxDepth);
+        seconds += other.seconds;
+    }
+};
+
+// ʱѾʱۼӵstats.seconds
+struct StatTimer
+{
+    SolveStats &stats;
+    chrono::steady_clock::time_point start;
+
+    explicit StatTimer(SolveStats &s) : stats(s), start(chrono::steady_clock::now())
+    {
+    }
+
+    ~StatTimer()
+    {
+        stats.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+};
+
+// ¼ݹȣʱȼ1ȣʱ1
+struct DepthGuard
+{
+    int &depth;
+
+    DepthGuard(int &d, int &maxDepth) : depth(d)
+    {
+        if (++depth > maxDepth)
+        {
+            maxDepth = depth;
+        }
+    }
+
+    ~DepthGuard()
+    {
+        --depth;
+    }
+};
+
+// ĳߴɹı߳BOXBOXΪ3ʱΪ׼9x9Ϊ245ʱֱΪ4x416x1625x25
+// ģBOXΪ9x9ʹBOXΪ3ʵ
+
+// SIZEֵС޷ͣСС
+template <int SIZE, bool FITS16 = (SIZE <= 16), bool FITS32 = (SIZE <= 32)>
+struct MaskOf
+{
+    typedef uint64_t type;
+};
+
+template <int SIZE>
+struct MaskOf<SIZE, true, true>
+{
+    typedef uint16_t type;
+};
+
+template <int SIZE>
+struct MaskOf<SIZE, false, true>
+{
+    typedef uint32_t type;
+};
+
+// Ϊ1λ
+template <class Mask>
+inline int popCount(Mask mask)
+{
+    return sizeof(Mask) <= 4 ? __builtin_popcount(mask) : __builtin_popcountll(mask);
+}
+
+// ͵Ϊ1λ±꣬maskΪ0
+template <class Mask>
+inline int lowestBit(Mask mask)
+{
+    return sizeof(Mask) <= 4 ? __builtin_ctz(mask) : __builtin_ctzll(mask);
+}
+
+// ַĶӦϵ0~8Ӧ'1'~'9'9ζӦ'A''B'
+// SIZE9ʱ֧ڱڼȥֱʹ'1' + digitͬ
+template <int SIZE>
+struct Symbols
+{
+    static char toChar(int digit)
+    {
+        return SIZE <= 9 || digit < 9 ? '1' + digit : 'A' + digit - 9;
+    }
+
+    static int toDigit(char c)
+    {
+        return SIZE <= 9 || c <= '9' ? c - '1' : c - 'A' + 9;
+    }
+
+    // cǷΪһϷַ
+    static bool isDigit(char c)
+    {
+        return ('1' <= c && c <= '9' && c - '1' < SIZE) || (SIZE > 9 && 'A' <= c && c < 'A' + SIZE - 9);
+    }
+};
+
+// ̣иӰһڴУֱӰֵҪκζѷ
+// ͨboard[i][j]ʵiеjеĸӣ'$'ʾո
+template <int BOX>
+struct BasicBoard
+{
+    static const int SIZE = BOX * BOX;
+
+    char cells[SIZE * SIZE];
+
+    BasicBoard()
+    {
+        memset(cells, '$', sizeof(cells));
+    }
+
+    char *operator[](int i)
+    {
+        return cells + i * SIZE;
+    }
+
+    const char *operator[](int i) const
+    {
+        return cells + i * SIZE;
+    }
+
+    bool operator==(const BasicBoard &other) const
+    {
+        return memcmp(cells, other.cells, sizeof(cells)) == 0;
+    }
+
+    bool operator!=(const BasicBoard &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<(const BasicBoard &other) const
+    {
+        return memcmp(cells, other.cells, sizeof(cells)) < 0;
+    }
+};
+
+typedef BasicBoard<3> Board;
+
+// һŵĽֻͼӵڴ棬ֻԴSolutionArenaû׷֮ǰЧ
+template <int BOX>
+struct BasicSolutionView
+{
+    typedef BasicBoard<BOX> Board;
+
+    const Board *first;
+    size_t count;
+
+    BasicSolutionView(const Board *f = NULL, size_t c = 0) : first(f), count(c)
+    {
+    }
+
+    BasicSolutionView(const vector<Board> &boards) : first(boards.data()), count(boards.size())
+    {
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    const Board &operator[](size_t k) const
+    {
+        return first[k];
+    }
+
+    const Board *begin() const
+    {
+        return first;
+    }
+
+    const Board *end() const
+    {
+        return first + count;
+    }
+};
+
+// Ĵ洢ţresettruncateֻ޸ڴ棬
+// ʱֻڽֵʱŷڴ
+template <int BOX>
+class BasicSolutionArena
+{
+public:
+    typedef BasicBoard<BOX> Board;
+    typedef BasicSolutionView<BOX> View;
+
+private:
+    vector<Board> records; // records[0, used)ΪЧĽ⣬ΪɸõĿռ
+    size_t used;
+
+public:
+    BasicSolutionArena() : used(0)
+    {
+    }
+
+    void push_back(const Board &board)
+    {
+        if (used < records.size())
+        {
+            records[used] = board;
+        }
+        else
+        {
+            records.push_back(board);
+        }
+        used++;
+    }
+
+    // ׷һ⣬ڴ洢еʼλ
+    size_t append(View solutions)
+    {
+        size_t start = used;
+        for (size_t k = 0; k < solutions.size(); k++)
+        {
+            push_back(solutions[k]);
+        }
+        return start;
+    }
+
+    void reset()
+    {
+        used = 0;
+    }
+
+    // count֮Ľ
+    void truncate(size_t count)
+    {
+        used = min(used, count);
+    }
+
+    size_t size() const
+    {
+        return used;
+    }
+
+    const Board &operator[](size_t k) const
+    {
+        return records[k];
+    }
+
+    View view() const
+    {
+        return View(records.data(), used);
+    }
+
+    View view(size_t from, size_t count) const
+    {
+        return View(records.data() + from, count);
+    }
+};
+
+typedef BasicSolutionView<3> SolutionView;
+typedef BasicSolutionArena<3> SolutionArena;
+
+// ɵ̱ʾʽÿһvectorɽӿڻת
+typedef vector<vector<char> > LegacyBoard;
+
+Board toBoard(const LegacyBoard &legacy)
+{
+    Board board;
+    for (int i = 0; i < N && i < (int)legacy.size(); i++)
+    {
+        for (int j = 0; j < N && j < (int)legacy[i].size(); j++)
+        {
+            board[i][j] = legacy[i][j];
+        }
+    }
+    return board;
+}
+
+LegacyBoard toLegacyBoard(const Board &board)
+{
+    LegacyBoard legacy(N, vector<char>(N));
+    for (int i = 0; i < N; i++)
+    {
+        legacy[i].assign(board[i], board[i] + N);
+    }
+    return legacy;
+}
+
+// ɣBOXΪı߳
+template <int BOX>
+class BasicSudokuPlayer
+{
+public:
+    static const int N = BOX * BOX; // ̱߳Ҳֵĸ
+    typedef BasicBoard<BOX> Board;
+    typedef typename MaskOf<N>::type Mask;
+    typedef Symbols<N> Sym;
+    typedef BasicSolutionView<BOX> SolutionView;
+    typedef function<void(const Board &)> SolutionVisitor; // ÿҵһһ
+
+    // еһDFS(board, pos)ʱȫ״̬ССʹboardõ
+    // ֵõ˳˳ֱȫͬ
+    struct Subtree
+    {
+        Board board;
+        vector<pair<int, int> > spaces;
+        int pos;
+        int depth; // ڵȣʹֺͳƵ벻ʱһ
+    };
+
+private:
+    static const Mask FULL = (Mask)((1ULL << N) - 1); // ֶõ
+    // ڿʱÿΨһʵĽڵ16x1625x25ڵٵʱἫֱӱø
+    static const long long DIG_CHECK_NODES = 1 << 10;
+    // һgenerateBoardΨһۼƷʳýڵٻԣ9x9Զﲻ
+    static const long long DIG_TOTAL_NODES = 1 << 18;
+
+    // ʹλʾĳǷֹ
+    // rowUsed[i] ʾiʹù֣columnUsed[j]ʾjʹù֣blockUsed[k]ʾkʹù
+    Mask rowUsed[N];
+    Mask columnUsed[N];
+    Mask blockUsed[N];
+
+    int solutionLimit; // ҵĽﵽֹͣ0ʾ
+    int solutionCount; // ҵĽ
+    bool recordResult; // ǷҵĽ⽻visitorvisitorΪNULLʱ浽result
+    const SolutionVisitor *visitor;
+    bool useMRV;       // ǷѡٵĿոMRV˳
+    bool usePropagation; // Ƿÿη֧ǰΨһѡΨһ
+    Pcg32 rng;           // ʹõ棬ÿSudokuPlayerӵУڶ߳иʹ
+    SolveStats stats;    // ϴresetStatsͳ
+    int depth;           // ǰ
+    long long nodesLeft; // ԷʵĽڵ
+    bool exhausted;      // Ƿڵֹ
+    long long digNodes;  // generateBoardΨһѷʵĽڵ
+
+public:
+    BasicSolutionArena<BOX> result; //洢ļϣÿǰõڴ
+    vector<pair<int, int> > spaces; // 洢пոλ
+
+public:
+    BasicSudokuPlayer()
+    {
+        depth = 0;
+        digNodes = 0;
+        useMRV = true;
+        usePropagation = true;
+        // ĬʹõǰϵͳʱΪ
+        seed(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        initState();
+    }
+
+    // ӣͬӺŻͬ
+    void seed(uint64_t s, uint64_t stream = 0)
+    {
+        rng.seed(s, stream);
+    }
+
+    // [0, n)Χڵ
+    int randInt(int n)
+    {
+        return rng.below(n);
+    }
+
+    // ˳trueΪÿѡѡٵĿոfalseΪspaces˳
+    void setMRV(bool enable)
+    {
+        useMRV = enable;
+    }
+
+    // ǷԼΨһѡΨһ
+    void setPropagation(bool enable)
+    {
+        usePropagation = enable;
+    }
+
+    // ͳsolveSudokugenerateBoardĶε֮ۼӣҪʱresetStats
+    const SolveStats &getStats() const
+    {
+        return stats;
+    }
+
+    void resetStats()
+    {
+        stats.clear();
+    }
+
+    void initState()
+    {
+        memset(rowUsed, 0, sizeof(rowUsed));
+        memset(columnUsed, 0, sizeof(columnUsed));
+        memset(blockUsed, 0, sizeof(blockUsed));
+        spaces.clear();
+        result.reset();
+        solutionLimit = 0;
+        solutionCount = 0;
+        recordResult = true;
+        visitor = NULL;
+        nodesLeft = LLONG_MAX;
+        exhausted = false;
+    }
+
+    void addResult(const Board &board)
+    {
+        if (visitor)
+        {
+            (*visitor)(board);
+        }
+        else
+        {
+            result.push_back(board);
+        }
+    }
+
+    static Mask bit(int digit)
+    {
+        return (Mask)((Mask)1 << digit);
+    }
+
+    //iСjСӦĹеdigitתdigitΪʹ״̬Ϊδʹã֮Ȼ
+    void flip(int i, int j, int digit)
+    {
+        rowUsed[i] ^= bit(digit);
+        columnUsed[j] ^= bit(digit);
+        blockUsed[(i / BOX) * BOX + j / BOX] ^= bit(digit);
+    }
+
+    // iСjеĿո񻹿ּϣdigitλΪ1ʾdigit
+    Mask candidates(int i, int j)
+    {
+        return (Mask)(~(rowUsed[i] | columnUsed[j] | blockUsed[(i / BOX) * BOX + j / BOX]) & FULL);
+    }
+
+    // spaces[pos]֮Ŀոҳѡٵһpos
+    // ѡͬʱѡ˳ǰĿոʹѡֻȡ̣ݺspacesҵ˳޹أ
+    // ״̬õĽ˳ͬ
+    void selectSpace(int pos)
+    {
+        int best = pos;
+        int bestCount = N + 1;
+        for (int k = pos; k < (int)spaces.size(); k++)
+        {
+            int count = popCount(candidates(spaces[k].first, spaces[k].second));
+            if (count < bestCount || (count == bestCount && spaces[k] < spaces[best]))
+            {
+                best = k;
+                bestCount = count;
+                if (count == 0) // ûкѡʱ÷֧һ޽⣬ؼȽ
+                {
+                    break;
+                }
+            }
+        }
+        swap(spaces[pos], spaces[best]);
+    }
+
+    // spaces[k]digit佻posʹspaces[0, pos]ΪĿո
+    void place(Board &board, int pos, int k, int digit)
+    {
+        swap(spaces[pos], spaces[k]);
+        int i = spaces[pos].first, j = spaces[pos].second;
+        flip(i, j, digit);
+        board[i][j] = Sym::toChar(digit);
+    }
+
+    // spaces[from, to)place
+    void unplace(Board &board, int from, int to)
+    {
+        for (int k = from; k < to; k++)
+        {
+            int i = spaces[k].first, j = spaces[k].second;
+            flip(i, j, Sym::toDigit(board[i][j]));
+            board[i][j] = '$';
+        }
+    }
+
+    // unitԪ0~N-1ΪУN~2N-1ΪУ2N~3N-1Ϊеĵk
+    void unitCell(int unit, int k, int &i, int &j)
+    {
+        if (unit < N)
+        {
+            i = unit;
+            j = k;
+        }
+        else if (unit < 2 * N)
+        {
+            i = k;
+            j = unit - N;
+        }
+        else
+        {
+            i = (unit - 2 * N) / BOX * BOX + k / BOX;
+            j = (unit - 2 * N) % BOX * BOX + k % BOX;
+        }
+    }
+
+    // ԼΨһѡĳֻʣһѡ֣ΨһĳСлֻһλÿ
+    // ĸνspaces[pos]ʹposƣfalseʾìܣʱĸɵ߳
+    bool propagate(Board &board, int &pos)
+    {
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int k = pos; k < (int)spaces.size(); k++)
+            {
+                Mask mask = candidates(spaces[k].first, spaces[k].second);
+                if (mask == 0)
+                {
+                    return false;
+                }
+                if ((mask & (mask - 1)) == 0)
+                {
+                    place(board, pos, k, lowestBit(mask));
+                    pos++;
+                    changed = true;
+                }
+            }
+            if (changed) // ȴ۸͵Ψһѡ
+            {
+                continue;
+            }
+            for (int unit = 0; unit < 3 * N; unit++)
+            {
+                // onceʾڵԪһλÿ֣moreʾλÿ
+                Mask once = 0, more = 0, filled = 0;
+                for (int k = 0; k < N; k++)
+                {
+                    int i, j;
+                    unitCell(unit, k, i, j);
+                    if (board[i][j] == '$')
+                    {
+                        Mask mask = candidates(i, j);
+                        more |= once & mask;
+                        once |= mask;
+                    }
+                    else
+                    {
+                        filled |= bit(Sym::toDigit(board[i][j]));
+                    }
+                }
+                if ((once | filled) != FULL) // ڸõԪ޴
+                {
+                    return false;
+                }
+                for (Mask hidden = once & ~more; hidden; hidden &= hidden - 1)
+                {
+                    int digit = lowestBit(hidden);
+                    for (int k = 0; k < N; k++)
+                    {
+                        int i, j;
+                        unitCell(unit, k, i, j);
+                        if (board[i][j] == '$' && (candidates(i, j) & bit(digit)))
+                        {
+                            place(board, pos, find(spaces.begin() + pos, spaces.end(), make_pair(i, j)) - spaces.begin(), digit);
+                            pos++;
+                            changed = true;
+                            break;
+                        }
+                        if (k == N - 1) // ΨһĸѱͬԪһΨһռ
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // ̳ʼոбԼССʹ
+    void loadBoard(const Board &board)
+    {
+        initState();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                if (board[i][j] == '$') // Ϊ'$'ʾ˸ΪգҪ
+                {
+                    spaces.push_back(pair<int, int>(i, j));
+                }
+                else // 򣬸ССʹ
+                {
+                    int digit = Sym::toDigit(board[i][j]);
+                    flip(i, j, digit);
+                }
+            }
+        }
+    }
+
+    // صͼָresultһ֮ǰЧ
+    SolutionView solveSudoku(const Board &board)
+    {
+        STAT(StatTimer timer(stats);)
+        loadBoard(board);
+        Board work = board;
+        DFS(work, 0);
+        return result.view();
+    }
+
+    // ʽ⣺ÿҵһvisitκν⣬ڴռ޹
+    // ҵlimitֹͣ0ʾƣҵĽlimitΪ2ʱ1˵Ψһ
+    int solveSudoku(const Board &board, const SolutionVisitor &visit, int limit = 0)
+    {
+        STAT(StatTimer timer(stats);)
+        loadBoard(board);
+        solutionLimit = limit;
+        visitor = &visit;
+        Board work = board;
+        DFS(work, 0);
+        visitor = NULL;
+        return solutionCount;
+    }
+
+    // ̶Ӧĸ
+    static Subtree rootSubtree(const Board &board)
+    {
+        Subtree tree;
+        tree.board = board;
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                if (board[i][j] == '$')
+                {
+                    tree.spaces.push_back(pair<int, int>(i, j));
+                }
+            }
+        }
+        tree.pos = 0;
+        tree.depth = 0;
+        return tree;
+    }
+
+    // tree״̬ÿҵһ⽻visitҵlimitֹͣ0ʾƣ
+    // budgetΪ-1ʱbudgetڵ㣬ʱֹ-1ѽvisitĽӦ
+    int solveSubtree(const Subtree &tree, const SolutionVisitor &visit, int limit, long long budget = -1)
+    {
+        STAT(StatTimer timer(stats);)
+        loadSubtree(tree);
+        solutionLimit = limit;
+        visitor = &visit;
+        nodesLeft = budget < 0 ? LLONG_MAX : budget;
+        Board work = tree.board;
+        depth = tree.depth;
+        DFS(work, tree.pos);
+        depth = 0;
+        visitor = NULL;
+        return exhausted ? -1 : solutionCount;
+    }
+
+    // treeչlevels֧˳õpropagateìܵķֱ֧Ӽȥ
+    // Ѿķ֧Ϊֻһ
+    void splitSubtree(const Subtree &tree, int levels, vector<Subtree> &parts)
+    {
+        loadSubtree(tree);
+        Board work = tree.board;
+        expand(work, tree.pos, tree.depth, levels, parts);
+    }
+
+    void loadSubtree(const Subtree &tree)
+    {
+        initState();
+        for (int k = 0; k < N * N; k++)
+        {
+            if (tree.board.cells[k] != '$')
+            {
+                flip(k / N, k % N, Sym::toDigit(tree.board.cells[k]));
+            }
+        }
+        spaces = tree.spaces;
+    }
+
+    // DFSķ֧ʽͬlevelsʱ¼ǰ״̬
+    void expand(Board &board, int pos, int level, int levels, vector<Subtree> &parts)
+    {
+        if (levels == 0)
+        {
+            Subtree part = {board, spaces, pos, level};
+            parts.push_back(part);
+            return;
+        }
+        int start = pos;
+        if (usePropagation && !propagate(board, pos))
+        {
+            unplace(board, start, pos);
+            return;
+        }
+        if (pos == (int)spaces.size())
+        {
+            Subtree part = {board, spaces, pos, level};
+            parts.push_back(part);
+            unplace(board, start, pos);
+            return;
+        }
+        if (useMRV)
+        {
+            selectSpace(pos);
+        }
+        int i = spaces[pos].first, j = spaces[pos].second;
+        for (Mask mask = candidates(i, j); mask; mask &= mask - 1)
+        {
+            int digit = lowestBit(mask);
+            flip(i, j, digit);
+            board[i][j] = Sym::toChar(digit);
+            expand(board, pos + 1, level + 1, levels - 1, parts);
+            flip(i, j, digit);
+            board[i][j] = '$';
+        }
+        unplace(board, start, pos);
+    }
+
+    // trueʾҵ㹻Ľڵ꣬Ҫֹ
+    bool DFS(Board &board, int pos)
+    {
+        if (--nodesLeft < 0)
+        {
+            exhausted = true;
+            return true;
+        }
+        STAT(stats.nodes++; DepthGuard guard(depth, stats.maxDepth);)
+        int start = pos;
+        if (usePropagation && !propagate(board, pos))
+        {
+            STAT(stats.propagations += pos - start; stats.backtracks++;)
+            unplace(board, start, pos);
+            return false;
+        }
+        STAT(stats.propagations += pos - start;)
+        if (pos == (int)spaces.size()) // пλʱ״̬Ϊһ
+        {
+            if (recordResult)
+            {
+                addResult(board);
+            }
+            solutionCount++;
+            unplace(board, start, pos);
+            return solutionLimit > 0 && solutionCount >= solutionLimit;
+        }
+        if (useMRV)
+        {
+            selectSpace(pos);
+        }
+        int i = spaces[pos].first, j = spaces[pos].second;
+        bool stop = false;
+        STAT(if (candidates(i, j) == 0) stats.backtracks++;)
+        // ڵiСjСӦĹжδʹùֲſԳ룬ֻömaskΪ1λ
+        for (Mask mask = candidates(i, j); mask; mask &= mask - 1)
+        {
+            int digit = lowestBit(mask);
+            flip(i, j, digit); // ССʹ
+            board[i][j] = Sym::toChar(digit); // 
+            stop = DFS(board, pos + 1); // һո
+            flip(i, j, digit); // ָССʹл
+            board[i][j] = '$'; // ָ״̬л
+            if (stop)
+            {
+                break;
+            }
+        }
+        unplace(board, start, pos); // Լ
+        return stop;
+    }
+
+    void getResult()
+    {
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            printBoard(result[i]);
+        }
+    }
+
+    bool checkBoard(const Board &board)
+    {
+        initState();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                // 㵱ǰϵַ֣תΪ
+                if (board[i][j] != '$' && board[i][j] != '.')
+                {
+                    int digit = Sym::toDigit(board[i][j]);
+
+                    // 鵱ǰǷڵСл߿Ѿʹù
+                    // ʹλ飺ӦλѾΪ1ôΪ0Ϊtrue
+                    // ʹλ|еʹ״̬Ȼʹλ루&ضλ
+                    if ((rowUsed[i] | columnUsed[j] | blockUsed[(i / BOX) * BOX + j / BOX]) & bit(digit))
+                    {
+                        return false;
+                    }
+                    flip(i, j, digit);
+                }
+            }
+        }
+        return true;
+    }
+
+    void printBoard(const Board &board)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                cout << board[i][j] << " ";
+            }
+            cout << "\n";
+        }
+    }
+
+    // 0~N-1һУ9x9Ϊ0~8
+    vector<int> getRand9()
+    {
+        // ʼһ0N-1
+        vector<int> result(N);
+        iota(result.begin(), result.end(), 0); 
+
+        // ʹñ
+        shuffle(result.begin(), result.end(), rng);
+        return result;
+    }
+    // ǰȥspaces.back()֮ǰΨһ⣬ҸøԭΪdigit
+    // ȥΨһ⣬ҽøʱ޽⣬ֻһ֪ⲻͬĽ
+    // DIG_CHECK_NODESڵ޽ʱͬtrue޷ȷΨһĸӲȥ
+    // ʱspaces.back()spaces[0]ո񼯺Ϻ״ֲ̬
+    bool hasOtherSolution(Board &board, int digit)
+    {
+        swap(spaces[0], spaces.back());
+        int x = spaces[0].first, y = spaces[0].second;
+        solutionLimit = 1;
+        solutionCount = 0;
+        recordResult = false;
+        nodesLeft = DIG_CHECK_NODES;
+        exhausted = false;
+        bool found = false;
+        for (Mask mask = candidates(x, y) & ~bit(digit); mask && !found; mask &= mask - 1)
+        {
+            int other = lowestBit(mask);
+            flip(x, y, other);
+            board[x][y] = Sym::toChar(other);
+            DFS(board, 1);
+            flip(x, y, other);
+            board[x][y] = '$';
+            found = solutionCount > 0 || exhausted;
+        }
+        digNodes += DIG_CHECK_NODES - nodesLeft;
+        nodesLeft = LLONG_MAX;
+        exhausted = false;
+        return found;
+    }
+
+    // һȥdigCountΨһ̣ڿչÿһ֤Ψһ
+    // ĳ޷ڵdigCountʱһԣೢmaxAttemptsΣۼƼڵDIG_TOTAL_NODESʱǰֹͣ
+    // ﲻʱڿһdugΪNULLʱʵȥĸ
+    Board generateBoard(int digCount, int *dug = NULL, int maxAttempts = 20)
+    {
+        STAT(StatTimer timer(stats);)
+        Board best;
+        int bestDug = -1;
+        digNodes = 0;
+        for (int attempt = 0; attempt < maxAttempts && bestDug < digCount && digNodes < DIG_TOTAL_NODES; attempt++)
+        {
+            int n = 0;
+            Board board = digBoard(digCount, n);
+            if (n > bestDug)
+            {
+                best = board;
+                bestDug = n;
+            }
+        }
+        if (dug != NULL)
+        {
+            *dug = bestDug;
+        }
+        return best;
+    }
+
+    // һ̲ȥdigCountӣ޷ȥʱǰdugʵȥĸ
+    Board digBoard(int digCount, int &dug)
+    {
+        Board board;
+        if (BOX == 3)
+        {
+            vector<int> row = getRand9();
+            for (int i = 0; i < 3; i++)
+            {
+                board[3][i + 3] = row[i] + '1';
+                board[4][i + 3] = row[i + 3] + '1';
+                board[5][i + 3] = row[i + 6] + '1';
+            }
+            copySquare(board, 3, 3, true);
+            copySquare(board, 3, 3, false);
+            copySquare(board, 3, 0, false);
+            copySquare(board, 3, 6, false);
+        }
+        else
+        {
+            fillPattern(board);
+        }
+
+        // Һ˳γȥÿӣÿֻһΣ
+        // ȥֻʹ࣬ĳӴʱȥ⣬֮Ҳһ
+        int order[N * N];
+        iota(order, order + N * N, 0);
+        shuffle(order, order + N * N, rng);
+        loadBoard(board); // ڿչһֱͬһССʹͿոб
+        int remaining = digCount;
+        for (int k = 0; k < N * N && remaining > 0; k++)
+        {
+            int x = order[k] / N, y = order[k] % N;
+            int digit = Sym::toDigit(board[x][y]);
+            flip(x, y, digit);
+            board[x][y] = '$';
+            spaces.push_back(pair<int, int>(x, y));
+
+            if (!hasOtherSolution(board, digit))
+            {
+                remaining--;
+            }
+            else // ָø
+            {
+                swap(spaces[0], spaces.back());
+                spaces.pop_back();
+                flip(x, y, digit);
+                board[x][y] = Sym::toChar(digit);
+            }
+        }
+        // printBoard(board);
+        // cout << "spaces " << player.spaces.size() << "\n";
+        if (!checkBoard(board))
+        {
+            cout << "wrong board" << endl;
+        }
+        dug = digCount - remaining;
+        return board;
+    }
+
+    // УУ˳ȴҹУУ˳ٷֱÿУУڵ˳
+    void randomLineOrder(int order[N])
+    {
+        int bands[BOX], inner[BOX];
+        iota(bands, bands + BOX, 0);
+        shuffle(bands, bands + BOX, rng);
+        for (int b = 0; b < BOX; b++)
+        {
+            iota(inner, inner + BOX, 0);
+            shuffle(inner, inner + BOX, rng);
+            for (int k = 0; k < BOX; k++)
+            {
+                order[b * BOX + k] = bands[b] * BOX + inner[k];
+            }
+        }
+    }
+
+    // 9x9̣Իģʽ(BOX * (r % BOX) + r / BOX + c) % NΪ
+    // ֡СУõһĺϷ
+    void fillPattern(Board &board)
+    {
+        vector<int> digits = getRand9();
+        int rows[N], columns[N];
+        randomLineOrder(rows);
+        randomLineOrder(columns);
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                int r = rows[i], c = columns[j];
+                board[i][j] = Sym::toChar(digits[(BOX * (r % BOX) + r / BOX + c) % N]);
+            }
+        }
+    }
+
+    // 9x9רãcopySquareķʽм3x3
+    void copySquare(Board &board, int src_x, int src_y, bool isRow)
+    {
+        // Ƶ˳
+        int rand_tmp = randInt(2) + 1;
+        int order_first[3] = {1, 2, 0};
+        int order_second[3] = {2, 0, 1};
+        if (rand_tmp == 2)
+        {
+            order_first[0] = 2;
+            order_first[1] = 0;
+            order_first[2] = 1;
+            order_second[0] = 1;
+            order_second[1] = 2;
+            order_second[2] = 0;
+        }
+
+        // ̽иƺ͵
+        for (int i = 0; i < 3; i++)
+        {
+            int order[2][3] = { {order_first[0], order_first[1], order_first[2]}, {order_second[0], order_second[1], order_second[2]} };
+            for (int j = 0; j < 2; j++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    if (isRow)
+                    {
+                        board[src_x + k][i + j * 6] = board[src_x + order[j][k]][src_y + i];
+                    }
+                    else
+                    {
+                        board[i + j * 6][src_y + k] = board[src_x + i][src_y + order[j][k]];
+                    }
+                }
+            }
+        }
+    }
+};
+
+typedef BasicSudokuPlayer<3> SudokuPlayer;
+typedef SudokuPlayer::SolutionVisitor SolutionVisitor;
+
+// 赸Dancing LinksתΪȷ⣬Algorithm X
+// 324Լÿǡһ֣81УÿÿǡóһΣ81У
+// ÿÿǡóһΣ81Уÿ3x3ÿǡóһΣ81У
+// 729кѡӦiеjdigitÿǡø4
+// ʮֻڹʱһΣÿ󶼻ȫָԷʹ
+class DlxSolver
+{
+private:
+    static const int COLUMNS = 4 * N * N;
+    static const int ROWS = N * N * N;
+    static const int NODES = 1 + COLUMNS + 4 * ROWS; // 0Ϊͷ1~COLUMNSΪ
+
+    int L[NODES], R[NODES], U[NODES], D[NODES];
+    int C[NODES];        // ڵڵ
+    int rowOf[NODES];    // ڵڵĺѡ
+    int S[COLUMNS + 1];  // ÿеǰʣĽڵ
+    int rowStart[ROWS];  // ÿѡеĵһڵ
+
+    Board work;          // ǰ״̬µ
+    int solutionLimit;
+    int solutionCount;
+    bool recordResult;
+    const SolutionVisitor *visitor; // ΪNULLʱ⽻visitor浽result
+    SolveStats stats;
+    int depth;
+
+    void cover(int c)
+    {
+        R[L[c]] = R[c];
+        L[R[c]] = L[c];
+        for (int i = D[c]; i != c; i = D[i])
+        {
+            for (int j = R[i]; j != i; j = R[j])
+            {
+                U[D[j]] = U[j];
+                D[U[j]] = D[j];
+                S[C[j]]--;
+            }
+        }
+    }
+
+    void uncover(int c)
+    {
+        for (int i = U[c]; i != c; i = U[i])
+        {
+            for (int j = L[i]; j != i; j = L[j])
+            {
+                S[C[j]]++;
+                U[D[j]] = j;
+                D[U[j]] = j;
+            }
+        }
+        R[L[c]] = c;
+        L[R[c]] = c;
+    }
+
+    // trueʾҵ㹻Ľ⣬Ҫֹ
+    bool search()
+    {
+        STAT(stats.nodes++; DepthGuard guard(depth, stats.maxDepth);)
+        if (R[0] == 0) // Լжѱǣõһ
+        {
+            if (recordResult)
+            {
+                if (visitor)
+                {
+                    (*visitor)(work);
+                }
+                else
+                {
+                    result.push_back(work);
+                }
+            }
+            solutionCount++;
+            return solutionLimit > 0 && solutionCount >= solutionLimit;
+        }
+        // ѡʣڵٵнз֧
+        int c = R[0];
+        for (int j = R[c]; j != 0; j = R[j])
+        {
+            if (S[j] < S[c])
+            {
+                c = j;
+            }
+        }
+        if (S[c] == 0)
+        {
+            STAT(stats.backtracks++;)
+            return false;
+        }
+        bool stop = false;
+        cover(c);
+        for (int r = D[c]; r != c && !stop; r = D[r])
+        {
+            for (int j = R[r]; j != r; j = R[j])
+            {
+                cover(C[j]);
+            }
+            int cell = rowOf[r] / N;
+            work.cells[cell] = '1' + rowOf[r] % N;
+            stop = search();
+            work.cells[cell] = '$';
+            for (int j = L[r]; j != r; j = L[j])
+            {
+                uncover(C[j]);
+            }
+        }
+        uncover(c);
+        return stop;
+    }
+
+    // е֣ѡжӦĺѡвУfalseʾֻͻ
+    bool selectGivens(const Board &board, vector<int> &covered)
+    {
+        vector<bool> used(COLUMNS + 1, false);
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            if (board.cells[cell] == '$')
+            {
+                continue;
+            }
+            int r = rowStart[cell * N + board.cells[cell] - '1'];
+            for (int k = 0, j = r; k < 4; k++, j = R[j])
+            {
+                if (used[C[j]])
+                {
+                    return false;
+                }
+                used[C[j]] = true;
+                cover(C[j]);
+                covered.push_back(C[j]);
+            }
+        }
+        return true;
+    }
+
+    void run(const Board &board)
+    {
+        STAT(StatTimer timer(stats);)
+        result.reset();
+        solutionCount = 0;
+        work = board;
+        vector<int> covered;
+        if (selectGivens(board, covered))
+        {
+            search();
+        }
+        for (int k = (int)covered.size() - 1; k >= 0; k--) // ෴˳ָʮ
+        {
+            uncover(covered[k]);
+        }
+    }
+
+public:
+    SolutionArena result; //洢ļϣÿǰõڴ
+
+    DlxSolver() : visitor(NULL), depth(0)
+    {
+        for (int c = 0; c <= COLUMNS; c++)
+        {
+            L[c] = c - 1;
+            R[c] = c + 1;
+            U[c] = D[c] = c;
+            C[c] = c;
+            S[c] = 0;
+        }
+        L[0] = COLUMNS;
+        R[COLUMNS] = 0;
+        int node = COLUMNS + 1;
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                for (int digit = 0; digit < N; digit++)
+                {
+                    int r = (i * N + j) * N + digit;
+                    int columns[4] = {
+                        1 + i * N + j,
+                        1 + N * N + i * N + digit,
+                        1 + 2 * N * N + j * N + digit,
+                        1 + 3 * N * N + ((i / 3) * 3 + j / 3) * N + digit};
+                    rowStart[r] = node;
+                    for (int k = 0; k < 4; k++, node++)
+                    {
+                        int c = columns[k];
+                        C[node] = c;
+                        rowOf[node] = r;
+                        // 뵽cĩβ
+                        U[node] = U[c];
+                        D[node] = c;
+                        D[U[c]] = node;
+                        U[c] = node;
+                        S[c]++;
+                        // ͬһѡеڵɻ
+                        L[node] = k == 0 ? node + 3 : node - 1;
+                        R[node] = k == 3 ? node - 3 : node + 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // صͼָresultһ֮ǰЧ
+    SolutionView solveSudoku(const Board &board)
+    {
+        solutionLimit = 0;
+        recordResult = true;
+        run(board);
+        return result.view();
+    }
+
+    // ͳƣ÷SudokuPlayerͬpropagationsʼΪ0
+    const SolveStats &getStats() const
+    {
+        return stats;
+    }
+
+    void resetStats()
+    {
+        stats.clear();
+    }
+
+    // ʽ⣬÷SudokuPlayer::solveSudoku(board, visit, limit)ͬ
+    int solveSudoku(const Board &board, const SolutionVisitor &visit, int limit = 0)
+    {
+        solutionLimit = limit;
+        recordResult = true;
+        visitor = &visit;
+        run(board);
+        visitor = NULL;
+        return solutionCount;
+    }
+};
+
+// ѶʹõĽ⼼ɣѶȴӵ͵
+enum Technique
+{
+    TECH_NONE,
+    TECH_HIDDEN_SINGLE,     // ΨһĳСлֻһλÿ
+    TECH_NAKED_SINGLE,      // Ψһѡĳֻʣһѡ
+    TECH_LOCKED_CANDIDATES, // ĳֻһУУУУУĳֻһ
+    TECH_NAKED_PAIR,        // ԣͬһԪĺѡǡͬ
+    TECH_HIDDEN_PAIR,       // ԣͬһԪֻͬ
+    TECH_X_WING,            // X-WingĳжֻͬУ֮
+    TECH_GUESS,             // ϼɶ޷ƽҪ
+    TECH_COUNT
+};
+
+const char *const TECHNIQUE_NAMES[TECH_COUNT] = {
+    "none", "hidden-single", "naked-single", "locked-candidates", "naked-pair", "hidden-pair", "x-wing", "guess"};
+
+// ÿʹһθüۼӵѶȷ
+const int TECHNIQUE_SCORES[TECH_COUNT] = {0, 1, 2, 5, 10, 15, 25, 100};
+
+struct Grade
+{
+    int score;              // Ѷȷ֣Ϊüɵķֵ֮
+    Technique hardest;      // õѼ
+    int steps[TECH_COUNT];  // ÿּʹõĴ
+    bool valid;             // ΪfalseʾֳͻƵгìܣ޽⣩
+};
+
+// Ѷֻʹ˹⼼⣬ÿһʹ򵥵Ŀüɣ
+// õļۼѶȷ֣¼ѵļɣмɶ޷ƽʱΪҪֹͣ
+// кѡֶ9λ뱣棬ɶϵλ
+class SudokuGrader
+{
+private:
+    int units[3 * N][N];   // 0~8ΪУ9~17ΪУ18~26Ϊ3x3飬ÿԪĸ
+    int peers[N * N][20];  // ÿͬСͬлͬ
+    int cand[N * N];       // ÿոĺѡ֣ĸΪ0
+    bool filled[N * N];
+    int placed[3 * N];     // ÿԪ
+    int empty;             // ʣĿո
+    bool broken;           // ƵзĳĳԪ޴
+
+    void place(int cell, int digit)
+    {
+        int i = cell / N, j = cell % N;
+        filled[cell] = true;
+        cand[cell] = 0;
+        empty--;
+        placed[i] |= 1 << digit;
+        placed[N + j] |= 1 << digit;
+        placed[2 * N + i / 3 * 3 + j / 3] |= 1 << digit;
+        for (int k = 0; k < 20; k++)
+        {
+            cand[peers[cell][k]] &= ~(1 << digit);
+        }
+    }
+
+    // unitгkeepԪ±룩ĸɾȥdigitsеĺѡ֣Ƿɾȥκκѡ
+    bool eliminate(int unit, int keep, int digits)
+    {
+        bool changed = false;
+        for (int k = 0; k < N; k++)
+        {
+            int cell = units[unit][k];
+            if (!(keep & (1 << k)) && (cand[cell] & digits))
+            {
+                cand[cell] &= ~digits;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // ԪпdigitĸӣԪ±룩
+    int positions(int unit, int digit)
+    {
+        int mask = 0;
+        for (int k = 0; k < N; k++)
+        {
+            if (cand[units[unit][k]] & (1 << digit))
+            {
+                mask |= 1 << k;
+            }
+        }
+        return mask;
+    }
+
+    int hiddenSingles()
+    {
+        int steps = 0;
+        for (int u = 0; u < 3 * N; u++)
+        {
+            int once = 0, more = 0;
+            for (int k = 0; k < N; k++)
+            {
+                int mask = cand[units[u][k]];
+                more |= once & mask;
+                once |= mask;
+            }
+            if ((once | placed[u]) != 0x1FF) // ĳּδõԪҲûпĸ
+            {
+                broken = true;
+                return steps;
+            }
+            for (int hidden = once & ~more; hidden; hidden &= hidden - 1)
+            {
+                int digit = __builtin_ctz(hidden);
+                int pos = positions(u, digit);
+                if (pos == 0) // ΨһĸѱͬһԪռãֶֻһ
+                {
+                    broken = true;
+                    return steps;
+                }
+                place(units[u][__builtin_ctz(pos)], digit);
+                steps++;
+            }
+        }
+        return steps;
+    }
+
+    int nakedSingles()
+    {
+        int steps = 0;
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            if (cand[cell] && (cand[cell] & (cand[cell] - 1)) == 0)
+            {
+                place(cell, __builtin_ctz(cand[cell]));
+                steps++;
+            }
+        }
+        return steps;
+    }
+
+    int lockedCandidates()
+    {
+        int steps = 0;
+        for (int digit = 0; digit < N; digit++)
+        {
+            for (int b = 0; b < N; b++)
+            {
+                // ڿdigitĸӶͬһлͬһʱӸУУɾȥdigit
+                int pos = positions(2 * N + b, digit);
+                if (pos == 0)
+                {
+                    continue;
+                }
+                int rowOfFirst = __builtin_ctz(pos) / 3, colOfFirst = __builtin_ctz(pos) % 3;
+                bool sameRow = true, sameColumn = true;
+                for (int m = pos; m; m &= m - 1)
+                {
+                    sameRow &= __builtin_ctz(m) / 3 == rowOfFirst;
+                    sameColumn &= __builtin_ctz(m) % 3 == colOfFirst;
+                }
+                int row = b / 3 * 3 + rowOfFirst, column = b % 3 * 3 + colOfFirst;
+                if (sameRow && eliminate(row, 7 << (b % 3 * 3), 1 << digit))
+                {
+                    steps++;
+                }
+                if (sameColumn && eliminate(N + column, 7 << (b / 3 * 3), 1 << digit))
+                {
+                    steps++;
+                }
+            }
+            for (int line = 0; line < 2 * N; line++)
+            {
+                // УУڿdigitĸӶͬһʱӸÿɾȥdigit
+                int pos = positions(line, digit);
+                if (pos == 0)
+                {
+                    continue;
+                }
+                int segment = __builtin_ctz(pos) / 3;
+                if (pos & ~(7 << (segment * 3)))
+                {
+                    continue;
+                }
+                int index = line % N;
+                int b = line < N ? index / 3 * 3 + segment : segment * 3 + index / 3;
+                int keep = 0;
+                for (int k = 0; k < N; k++)
+                {
+                    int r = units[2 * N + b][k] / N, c = units[2 * N + b][k] % N;
+                    if ((line < N && r == index) || (line >= N && c == index))
+                    {
+                        keep |= 1 << k;
+                    }
+                }
+                if (eliminate(2 * N + b, keep, 1 << digit))
+                {
+                    steps++;
+                }
+            }
+        }
+        return steps;
+    }
+
+    int nakedPairs()
+    {
+        int steps = 0;
+        for (int u = 0; u < 3 * N; u++)
+        {
+            for (int a = 0; a < N; a++)
+            {
+                int mask = cand[units[u][a]];
+                if (__builtin_popcount(mask) != 2)
+                {
+                    continue;
+                }
+                for (int b = a + 1; b < N; b++)
+                {
+                    if (cand[units[u][b]] == mask && eliminate(u, (1 << a) | (1 << b), mask))
+                    {
+                        steps++;
+                    }
+                }
+            }
+        }
+        return steps;
+    }
+
+    int hiddenPairs()
+    {
+        int steps = 0;
+        for (int u = 0; u < 3 * N; u++)
+        {
+            int pos[N];
+            for (int digit = 0; digit < N; digit++)
+            {
+                pos[digit] = positions(u, digit);
+            }
+            for (int d1 = 0; d1 < N; d1++)
+            {
+                if (__builtin_popcount(pos[d1]) != 2)
+                {
+                    continue;
+                }
+                for (int d2 = d1 + 1; d2 < N; d2++)
+                {
+                    if (pos[d2] != pos[d1])
+                    {
+                        continue;
+                    }
+                    // ֻd1d2ɾȥǵѡ
+                    int keep = (1 << d1) | (1 << d2);
+                    bool changed = false;
+                    for (int m = pos[d1]; m; m &= m - 1)
+                    {
+                        int cell = units[u][__builtin_ctz(m)];
+                        changed |= (cand[cell] & ~keep) != 0;
+                        cand[cell] &= keep;
+                    }
+                    if (changed)
+                    {
+                        steps++;
+                    }
+                }
+            }
+        }
+        return steps;
+    }
+
+    int xWings()
+    {
+        int steps = 0;
+        for (int digit = 0; digit < N; digit++)
+        {
+            for (int base = 0; base < 2 * N; base += N) // baseΪ0ʱΪ׼ΪNʱΪ׼
+            {
+                int pos[N];
+                for (int k = 0; k < N; k++)
+                {
+                    pos[k] = positions(base + k, digit);
+                }
+                for (int a = 0; a < N; a++)
+                {
+                    if (__builtin_popcount(pos[a]) != 2)
+                    {
+                        continue;
+                    }
+                    for (int b = a + 1; b < N; b++)
+                    {
+                        if (pos[b] != pos[a])
+                        {
+                            continue;
+                        }
+                        // УУɾȥdigit
+                        bool changed = false;
+                        for (int m = pos[a]; m; m &= m - 1)
+                        {
+                            int cross = (N - base) + __builtin_ctz(m);
+                            changed |= eliminate(cross, (1 << a) | (1 << b), 1 << digit);
+                        }
+                        if (changed)
+                        {
+                            steps++;
+                        }
+                    }
+                }
+            }
+        }
+        return steps;
+    }
+
+    bool contradiction()
+    {
+        if (broken)
+        {
+            return true;
+        }
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            if (!filled[cell] && cand[cell] == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    SudokuGrader()
+    {
+        for (int k = 0; k < N; k++)
+        {
+            for (int m = 0; m < N; m++)
+            {
+                units[k][m] = k * N + m;
+                units[N + k][m] = m * N + k;
+                units[2 * N + k][m] = (k / 3 * 3 + m / 3) * N + k % 3 * 3 + m % 3;
+            }
+        }
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            int count = 0, i = cell / N, j = cell % N;
+            for (int other = 0; other < N * N; other++)
+            {
+                int r = other / N, c = other % N;
+                if (other != cell && (r == i || c == j || (r / 3 == i / 3 && c / 3 == j / 3)))
+                {
+                    peers[cell][count++] = other;
+                }
+            }
+        }
+    }
+
+    Grade grade(const Board &board)
+    {
+        Grade g;
+        memset(&g, 0, sizeof(g));
+        g.valid = true;
+        empty = 0;
+        broken = false;
+        memset(placed, 0, sizeof(placed));
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            filled[cell] = false;
+            cand[cell] = 0x1FF;
+            empty++;
+        }
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            char c = board.cells[cell];
+            if (c == '$' || c == '.')
+            {
+                continue;
+            }
+            if (!(cand[cell] & (1 << (c - '1')))) // ֳͻ
+            {
+                g.valid = false;
+                return g;
+            }
+            place(cell, c - '1');
+        }
+
+        while (empty > 0)
+        {
+            if (contradiction())
+            {
+                g.valid = false;
+                break;
+            }
+            Technique used = TECH_GUESS;
+            int steps = 0;
+            if ((steps = hiddenSingles()) > 0 || broken)
+                used = TECH_HIDDEN_SINGLE;
+            else if ((steps = nakedSingles()) > 0)
+                used = TECH_NAKED_SINGLE;
+            else if ((steps = lockedCandidates()) > 0)
+                used = TECH_LOCKED_CANDIDATES;
+            else if ((steps = nakedPairs()) > 0)
+                used = TECH_NAKED_PAIR;
+            else if ((steps = hiddenPairs()) > 0)
+                used = TECH_HIDDEN_PAIR;
+            else if ((steps = xWings()) > 0)
+                used = TECH_X_WING;
+            else
+                steps = 1;
+            g.steps[used] += steps;
+            g.score += steps * TECHNIQUE_SCORES[used];
+            g.hardest = max(g.hardest, used);
+            if (used == TECH_GUESS)
+            {
+                break;
+            }
+        }
+        return g;
+    }
+};
+
+char data[9][9] = {
+    {'5', '3', '.', '.', '7', '.', '.', '.', '.'},
+    {'6', '.', '.', '1', '9', '5', '.', '.', '.'},
+    {'.', '9', '8', '.', '.', '.', '.', '6', '.'},
+    {'8', '.', '.', '.', '6', '.', '.', '.', '3'},
+    {'4', '.', '.', '8', '.', '3', '.', '.', '1'},
+    {'7', '.', '.', '.', '2', '.', '.', '.', '6'},
+    {'.', '6', '.', '.', '.', '.', '2', '8', '.'},
+    {'.', '.', '.', '4', '1', '9', '.', '.', '5'},
+    {'.', '.', '.', '.', '8', '.', '.', '7', '9'}};
+
+void test()
+{
+    SudokuPlayer player;
+    Board board;
+
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            board[i][j] = data[i][j];
+        }
+    }
+    bool check = player.checkBoard(board);
+    if (check)
+        cout << "checked" << endl;
+
+    player.solveSudoku(board);
+    player.getResult();
+
+    cout << endl;
+}
+
+// ̸ʽÿռ4λֲֻ15̣4x49x9
+//   ļͷ16ֽڣħ"SDKB"汾ţ1ֽڣı߳BOX1ֽڣ2ֽڣ8ֽڣС
+//   ֮Ϊ¼kλHEADER_SIZE + k * RECORD_SIZEֱӰ±궨λ
+//   ¼еkֽڣ4λǰΪkӣ0Ϊո1~NΪ֣
+//   һ֮İֽΪ1ʾǰһͬһĿıʽбŲΪ0Ľ
+// 9x9ÿ¼41ֽڣıʽԼΪ190ֽ
+template <int BOX>
+struct BinaryFormat
+{
+    static const int N = BOX * BOX;
+    static const size_t HEADER_SIZE = 16;
+    static const size_t RECORD_SIZE = N * N / 2 + 1;
+    static const int VERSION = 1;
+
+    static void writeHeader(unsigned char *p, uint64_t count)
+    {
+        memcpy(p, "SDKB", 4);
+        p[4] = VERSION;
+        p[5] = BOX;
+        p[6] = p[7] = 0;
+        for (int k = 0; k < 8; k++)
+        {
+            p[8 + k] = (unsigned char)(count >> (8 * k));
+        }
+    }
+
+    static bool isHeader(const char *p)
+    {
+        return memcmp(p, "SDKB", 4) == 0;
+    }
+
+    static void encode(const BasicBoard<BOX> &board, bool continued, unsigned char *p)
+    {
+        memset(p, 0, RECORD_SIZE);
+        for (int k = 0; k < N * N; k++)
+        {
+            char c = board.cells[k];
+            int value = c == '$' ? 0 : Symbols<N>::toDigit(c) + 1;
+            p[k >> 1] |= value << ((k & 1) * 4);
+        }
+        p[(N * N) >> 1] |= (continued ? 1 : 0) << ((N * N & 1) * 4);
+    }
+
+    // ظǷǰһͬһĿ
+    static bool decode(const unsigned char *p, BasicBoard<BOX> &board)
+    {
+        for (int k = 0; k < N * N; k++)
+        {
+            int value = (p[k >> 1] >> ((k & 1) * 4)) & 0xF;
+            board.cells[k] = value == 0 ? '$' : Symbols<N>::toChar(value - 1);
+        }
+        return ((p[(N * N) >> 1] >> ((N * N & 1) * 4)) & 0xF) != 0;
+    }
+};
+
+// ʽȡļԴ黺ļ߶ֱӽBoardУڴռļС޹
+// ָ֧ʽ9x9Ϊߴƣ
+//   1. writeFileĸʽÿ9ӣ֮"-------"ͷзָ
+//   2. ÿ81ַĵиʽ'.''0'ʾո
+//   3. BinaryFormatƸʽļͷħԶʶ
+// е'$''.''0'ᱻΪ'$'ַո񡢻еȣԣ
+// 9x910ϵ'A''B'ʾ
+template <int BOX>
+class BasicBoardReader
+{
+private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+    static const int N = BOX * BOX;
+    typedef BasicBoard<BOX> Board;
+    typedef BinaryFormat<BOX> Binary;
+
+    FILE *fp;
+    vector<char> buffer;
+    size_t pos, len;    // bufferδΪ[pos, len)
+    bool binary;        // ǷΪƸʽ
+    Board tmp;          // иʽڶ
+    int count;          // tmpѶĸ
+    bool broken;        // ǰиʽУһָΪֹ
+    char line[N * N];   // ǰеĸ
+    int lineCells;      // ǰеĸܳN * N
+    bool lineStart;     // һַǷλ
+    bool separator;     // ǰǷΪָ
+    int sepIndex;       // ǰָеıţintΧʱΪ-1
+    bool held;          // ǰѶ굫δȷ֮ǰ̣
+    int lineNo;         // ǰекţڱʽ
+    int lastIndex;      // һζ̵ı
+
+    // ѽʱļжһ飬ļʱfalse
+    bool fill()
+    {
+        if (pos < len)
+        {
+            return true;
+        }
+        len = fp ? fread(buffer.data(), 1, buffer.size(), fp) : 0;
+        pos = 0;
+        return len > 0;
+    }
+
+    // bufferжȡnֽڣԽ߽ʱԶһ飬ļʣ಻nֽʱfalse
+    bool readBytes(unsigned char *dst, size_t n)
+    {
+        while (n > 0)
+        {
+            if (!fill())
+            {
+                return false;
+            }
+            size_t k = min(n, len - pos);
+            memcpy(dst, buffer.data() + pos, k);
+            pos += k;
+            dst += k;
+            n -= k;
+        }
+        return true;
+    }
+
+    // tmpʼȡһ
+    void take(Board &board, int index)
+    {
+        board = tmp;
+        tmp = Board();
+        count = 0;
+        lastIndex = index;
+    }
+
+    // tmpв
+    void discard()
+    {
+        tmp = Board();
+        count = 0;
+    }
+
+    void resetLine()
+    {
+        lineCells = 0;
+        lineStart = true;
+        separator = false;
+        sepIndex = 0;
+        lineNo++;
+    }
+
+    // һУõһʱtrue
+    // иʽһN * NӼΪһ̣иʽNÿNӣķָи
+    // ָʽԼ̶
+    bool endLine(Board &board)
+    {
+        if (separator)
+        {
+            if (sepIndex < 0)
+            {
+                printf("%dзָеıųΧѺ\n", lineNo);
+                discard();
+                broken = false;
+                return false;
+            }
+            if (count == N * N)
+            {
+                take(board, sepIndex);
+                return true;
+            }
+            if (count > 0)
+            {
+                printf("%d֮ǰ̲%dУѺ\n", lineNo, N);
+                discard();
+            }
+            broken = false;
+            return false;
+        }
+        if (lineCells == 0) // 
+        {
+            return false;
+        }
+        if (count == N * N) // иʽ֮ûзָУȷǰ´δ
+        {
+            held = true;
+            take(board, 0);
+            return true;
+        }
+        if (lineCells == N * N && count == 0)
+        {
+            memcpy(board.cells, line, N * N);
+            lastIndex = 0;
+            broken = false;
+            return true;
+        }
+        if (lineCells == N && !broken)
+        {
+            memcpy(tmp.cells + count, line, N);
+            count += N;
+            return false;
+        }
+        if (!broken)
+        {
+            printf("%d%dӣӦΪ%dиʽ%dиʽѺ\n", lineNo, lineCells, N, N * N);
+            discard();
+            broken = true;
+        }
+        return false;
+    }
+
+public:
+    explicit BasicBoardReader(const string &filePath)
+        : buffer(BUFFER_SIZE), pos(0), len(0), binary(false), count(0), broken(false), held(false), lineNo(0),
+          lastIndex(0)
+    {
+        resetLine();
+        fp = fopen(filePath.c_str(), "rb");
+        if (fp && fill() && len >= Binary::HEADER_SIZE && Binary::isHeader(buffer.data()))
+        {
+            if (buffer[5] != BOX)
+            {
+                printf("ļйı߳Ϊ%dbһ\n", buffer[5]);
+                exit(0);
+            }
+            binary = true;
+            pos = Binary::HEADER_SIZE;
+        }
+    }
+
+    ~BasicBoardReader()
+    {
+        if (fp)
+        {
+            fclose(fp);
+        }
+    }
+
+    bool isOpen() const
+    {
+        return fp != NULL;
+    }
+
+    // һnext̵ıţıʽΪָе֣иʽΪ0
+    // ƸʽǰһͬһĿʱΪǰһż1Ϊ0
+    int index() const
+    {
+        return lastIndex;
+    }
+
+    // ȡһ̣ļûиʱfalse
+    bool next(Board &board)
+    {
+        if (binary)
+        {
+            unsigned char record[Binary::RECORD_SIZE];
+            if (!readBytes(record, Binary::RECORD_SIZE))
+            {
+                return false;
+            }
+            lastIndex = Binary::decode(record, board) ? lastIndex + 1 : 0;
+            return true;
+        }
+        if (held)
+        {
+            held = false;
+            bool done = endLine(board);
+            resetLine();
+            if (done)
+            {
+                return true;
+            }
+        }
+        while (fill())
+        {
+            char c = buffer[pos++];
+            if (c == '\n')
+            {
+                bool done = endLine(board);
+                if (!held)
+                {
+                    resetLine();
+                }
+                if (done)
+                {
+                    return true;
+                }
+                continue;
+            }
+            if (lineStart)
+            {
+                lineStart = false;
+                if (c == '-') // ָ
+                {
+                    separator = true;
+                    continue;
+                }
+            }
+            if (separator)
+            {
+                if ('0' <= c && c <= '9' && sepIndex >= 0)
+                {
+                    // ųintΧʱΪ-1endLineаʽ
+                    int d = c - '0';
+                    sepIndex = sepIndex > (INT_MAX - d) / 10 ? -1 : sepIndex * 10 + d;
+                }
+                continue;
+            }
+            char cell;
+            if (Symbols<N>::isDigit(c))
+            {
+                cell = c;
+            }
+            else if (c == '$' || c == '.' || c == '0')
+            {
+                cell = '$';
+            }
+            else
+            {
+                continue;
+            }
+            if (lineCells < N * N)
+            {
+                line[lineCells] = cell;
+            }
+            lineCells++;
+        }
+        // ļĩβûлзһУԼûзָе
+        if (!lineStart && !held)
+        {
+            bool done = endLine(board);
+            lineStart = true;
+            lineCells = 0;
+            separator = false;
+            if (done)
+            {
+                return true;
+            }
+        }
+        if (count == N * N)
+        {
+            take(board, 0);
+            return true;
+        }
+        if (count > 0)
+        {
+            printf("ļĩβ̲%dУѺ\n", N);
+            discard();
+        }
+        return false;
+    }
+
+    // ȡmaxCount׷ӵboardsУʵʶȡ
+    size_t nextBatch(vector<Board> &boards, size_t maxCount)
+    {
+        Board board;
+        size_t n = 0;
+        while (n < maxCount && next(board))
+        {
+            boards.push_back(board);
+            n++;
+        }
+        return n;
+    }
+};
+
+typedef BasicBoardReader<3> BoardReader;
+
+vector<Board> readFile(string filePath)
+{
+    BoardReader reader(filePath);
+    vector<Board> boards;
+    reader.nextBatch(boards, SIZE_MAX);
+    return boards;
+}
+
+// ʽFORMAT_TEXTΪÿNӲ"------- k -------"ָFORMAT_LINEΪÿһN * Nַ
+// FORMAT_BINARYΪBinaryFormatƸʽ
+enum OutputFormat
+{
+    FORMAT_TEXT,
+    FORMAT_LINE,
+    FORMAT_BINARY
+};
+
+// ʽԤȷĻУʱһдļ
+// endlÿˢһ
+template <int BOX>
+class BasicBoardWriter
+{
+private:
+    static const int N = BOX * BOX;
+    typedef BasicBoard<BOX> Board;
+
+    // ıʽһռõֽNÿN"+ո"ټӻз
+    // Ϸָ"------- %d -------\n"11ַţԼsnprintfдĽβ'\0'
+    static const size_t SEPARATOR_SIZE = sizeof("------- ") - 1 + 11 + sizeof(" -------\n") - 1;
+    static const size_t TEXT_RECORD_SIZE = N * (2 * N + 1) + SEPARATOR_SIZE + 1;
+
+    ofstream &out;
+    OutputFormat format;
+    vector<char> buffer;
+    size_t len;
+    streampos headerPos; // Ƹʽļͷļеλ
+    uint64_t written;    // д
+
+public:
+    BasicBoardWriter(ofstream &f, OutputFormat fmt = FORMAT_TEXT, size_t capacity = 1 << 20)
+        : out(f), format(fmt), buffer(max(capacity, TEXT_RECORD_SIZE)), len(0), written(0)
+    {
+        if (format == FORMAT_BINARY)
+        {
+            // дΪ0ļͷÿflushʱٸΪʵ
+            headerPos = out.tellp();
+            BinaryFormat<BOX>::writeHeader((unsigned char *)buffer.data(), 0);
+            len = BinaryFormat<BOX>::HEADER_SIZE;
+        }
+    }
+
+    ~BasicBoardWriter()
+    {
+        flush();
+    }
+
+    // дһ̣indexΪıʽָеı
+    void write(const Board &board, int index)
+    {
+        if (buffer.size() - len < TEXT_RECORD_SIZE)
+        {
+            flush();
+        }
+        char *p = buffer.data() + len;
+        written++;
+        if (format == FORMAT_BINARY)
+        {
+            BinaryFormat<BOX>::encode(board, index > 0, (unsigned char *)p);
+            p += BinaryFormat<BOX>::RECORD_SIZE;
+        }
+        else if (format == FORMAT_LINE)
+        {
+            memcpy(p, board.cells, N * N);
+            p += N * N;
+            *p++ = '\n';
+        }
+        else
+        {
+            for (int i = 0; i < N; i++)
+            {
+                for (int j = 0; j < N; j++)
+                {
+                    *p++ = board[i][j];
+                    *p++ = ' ';
+                }
+                *p++ = '\n';
+            }
+            p += snprintf(p, buffer.size() - (p - buffer.data()), "------- %d -------\n", index);
+        }
+        len = p - buffer.data();
+    }
+
+    // дһ̣Ŵ0ʼ
+    void write(BasicSolutionView<BOX> boards)
+    {
+        for (size_t k = 0; k < boards.size(); k++)
+        {
+            write(boards[k], k);
+        }
+    }
+
+    void flush()
+    {
+        if (len > 0)
+        {
+            out.write(buffer.data(), len);
+            len = 0;
+        }
+        if (format == FORMAT_BINARY)
+        {
+            unsigned char header[BinaryFormat<BOX>::HEADER_SIZE];
+            BinaryFormat<BOX>::writeHeader(header, written);
+            streampos end = out.tellp();
+            out.seekp(headerPos);
+            out.write((const char *)header, sizeof(header));
+            out.seekp(end);
+        }
+    }
+};
+
+// maxȰýղĺODRʹڳʼľ̬Ҫⶨ
+template <int BOX>
+const size_t BasicBoardWriter<BOX>::SEPARATOR_SIZE;
+template <int BOX>
+const size_t BasicBoardWriter<BOX>::TEXT_RECORD_SIZE;
+
+typedef BasicBoardWriter<3> BoardWriter;
+
+void writeFile(const vector<Board> &boards, ofstream &f)
+{
+    BoardWriter writer(f, FORMAT_TEXT, boards.size() * N * N * 3);
+    writer.write(boards);
+}
+
+// ͳƣļ.jsonβʱJSON飬ͷCSV
+class StatsWriter
+{
+private:
+    ofstream out;
+    bool json;
+    bool first;
+
+public:
+    explicit StatsWriter(const string &path) : out(path.c_str(), ios::out | ios::trunc), first(true)
+    {
+        json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        if (json)
+        {
+            out << "[";
+        }
+        else
+        {
+            out << "index,holes,solutions,nodes,backtracks,max_depth,propagations,microseconds\n";
+        }
+    }
+
+    ~StatsWriter()
+    {
+        if (json)
+        {
+            out << (first ? "]\n" : "\n]\n");
+        }
+    }
+
+    // indexΪ̱ţpuzzleΪĿͳƿոsolutionsΪҵĽ
+    template <class BoardType>
+    void add(size_t index, const BoardType &puzzle, int solutions, const SolveStats &s)
+    {
+        int holes = count(puzzle.cells, puzzle.cells + sizeof(puzzle.cells), '$');
+        char line[256];
+        const char *fmt = json ? "%s\n  {\"index\": %zu, \"holes\": %d, \"solutions\": %d, \"nodes\": %llu, "
+                                 "\"backtracks\": %llu, \"max_depth\": %d, \"propagations\": %llu, \"microseconds\": %.1f}"
+                               : "%s%zu,%d,%d,%llu,%llu,%d,%llu,%.1f\n";
+        snprintf(line, sizeof(line), fmt, json && !first ? "," : "", index, holes, solutions,
+                 (unsigned long long)s.nodes, (unsigned long long)s.backtracks, s.maxDepth,
+                 (unsigned long long)s.propagations, s.seconds * 1e6);
+        out << line;
+        first = false;
+    }
+};
+
+// Уʹõ㣬һеÿ16λͨӦһ̵9λ
+// ݱѡѡAVX216̣SSE28̣ʵ֣1̣
+#if defined(__AVX2__)
+struct MaskLanes
+{
+    typedef __m256i V;
+    static const int WIDTH = 16;
+    static V zero() { return _mm256_setzero_si256(); }
+    static V load(const uint16_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+    static void store(uint16_t *p, V v) { _mm256_storeu_si256((__m256i *)p, v); }
+    static V bitOr(V a, V b) { return _mm256_or_si256(a, b); }
+    static V bitAnd(V a, V b) { return _mm256_and_si256(a, b); }
+    static V andNot(V a, V b) { return _mm256_andnot_si256(a, b); } // ~a & b
+    static V isZero(V a) { return _mm256_cmpeq_epi16(a, zero()); } // Ϊ0ͨΪȫ1
+    static V full() { return _mm256_set1_epi16(0x1FF); }
+};
+#elif defined(__SSE2__)
+struct MaskLanes
+{
+    typedef __m128i V;
+    static const int WIDTH = 8;
+    static V zero() { return _mm_setzero_si128(); }
+    static V load(const uint16_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+    static void store(uint16_t *p, V v) { _mm_storeu_si128((__m128i *)p, v); }
+    static V bitOr(V a, V b) { return _mm_or_si128(a, b); }
+    static V bitAnd(V a, V b) { return _mm_and_si128(a, b); }
+    static V andNot(V a, V b) { return _mm_andnot_si128(a, b); } // ~a & b
+    static V isZero(V a) { return _mm_cmpeq_epi16(a, zero()); } // Ϊ0ͨΪȫ1
+    static V full() { return _mm_set1_epi16(0x1FF); }
+};
+#else
+struct MaskLanes
+{
+    typedef uint16_t V;
+    static const int WIDTH = 1;
+    static V zero() { return 0; }
+    static V load(const uint16_t *p) { return *p; }
+    static void store(uint16_t *p, V v) { *p = v; }
+    static V bitOr(V a, V b) { return a | b; }
+    static V bitAnd(V a, V b) { return a & b; }
+    static V andNot(V a, V b) { return ~a & b; }
+    static V isZero(V a) { return a == 0 ? 0xFFFF : 0; }
+    static V full() { return 0x1FF; }
+};
+#endif
+
+// ַӳ䣬ոַΪ0
+struct DigitBits
+{
+    uint16_t bit[256];
+
+    DigitBits()
+    {
+        memset(bit, 0, sizeof(bit));
+        for (int d = 0; d < N; d++)
+        {
+            bit['1' + d] = 1 << d;
+        }
+    }
+};
+
+// У̣valid[k]Ϊboards[k]ССǷ񻥲ظ
+// candidatesΪNULLʱͬʱÿӵĺѡּcandidates[k * 81 + cell]Ϊ0
+// ÿͬʱMaskLanes::WIDTḤ̵ССֱλĲͬͨ
+void checkBoards(const Board *boards, size_t count, bool *valid, uint16_t *candidates = NULL)
+{
+    typedef MaskLanes::V V;
+    const int W = MaskLanes::WIDTH;
+    static const DigitBits digits; // ھֻ̬ʼһΣC++11֤߳ͬʱʱʼ̰߳ȫ
+    uint16_t bits[N * N][W]; // תú룬bits[cell][lane]
+    uint16_t lanes[W];
+    for (size_t base = 0; base < count; base += W)
+    {
+        int n = min<size_t>(W, count - base);
+        for (int cell = 0; cell < N * N; cell++)
+        {
+            for (int lane = 0; lane < W; lane++)
+            {
+                bits[cell][lane] = lane < n ? digits.bit[(unsigned char)boards[base + lane].cells[cell]] : 0;
+            }
+        }
+        V rows[N], columns[N], blocks[N];
+        for (int k = 0; k < N; k++)
+        {
+            rows[k] = columns[k] = blocks[k] = MaskLanes::zero();
+        }
+        V conflict = MaskLanes::zero();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                V bit = MaskLanes::load(bits[i * N + j]);
+                int b = (i / 3) * 3 + j / 3;
+                V used = MaskLanes::bitOr(MaskLanes::bitOr(rows[i], columns[j]), blocks[b]);
+                conflict = MaskLanes::bitOr(conflict, MaskLanes::bitAnd(used, bit));
+                rows[i] = MaskLanes::bitOr(rows[i], bit);
+                columns[j] = MaskLanes::bitOr(columns[j], bit);
+                blocks[b] = MaskLanes::bitOr(blocks[b], bit);
+            }
+        }
+        MaskLanes::store(lanes, conflict);
+        for (int lane = 0; lane < n; lane++)
+        {
+            valid[base + lane] = lanes[lane] == 0;
+        }
+        if (candidates == NULL)
+        {
+            continue;
+        }
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                V bit = MaskLanes::load(bits[i * N + j]);
+                V used = MaskLanes::bitOr(MaskLanes::bitOr(rows[i], columns[j]), blocks[(i / 3) * 3 + j / 3]);
+                // δʹõֻ֣ոڵͨ
+                V cand = MaskLanes::bitAnd(MaskLanes::andNot(used, MaskLanes::full()), MaskLanes::isZero(bit));
+                MaskLanes::store(lanes, cand);
+                for (int lane = 0; lane < n; lane++)
+                {
+                    candidates[(base + lane) * N * N + i * N + j] = lanes[lane];
+                }
+            }
+        }
+    }
+}
+
+// ̵ĵȼ۱任ȰtransposeתãٰrowscolumnsкУdдΪdigits[d]
+// 任rеcΪdigits[תú̵rows[r]еcolumns[c]е]
+struct BoardTransform
+{
+    bool transpose;
+    int rows[N];
+    int columns[N];
+    char digits[N];
+
+    Board apply(const Board &board) const
+    {
+        Board out;
+        for (int r = 0; r < N; r++)
+        {
+            for (int c = 0; c < N; c++)
+            {
+                char ch = transpose ? board[columns[c]][rows[r]] : board[rows[r]][columns[c]];
+                out[r][c] = ch == '$' ? '$' : digits[ch - '1'];
+            }
+        }
+        return out;
+    }
+
+    Board invert(const Board &board) const
+    {
+        char inverse[N];
+        for (int d = 0; d < N; d++)
+        {
+            inverse[digits[d] - '1'] = '1' + d;
+        }
+        Board out;
+        for (int r = 0; r < N; r++)
+        {
+            for (int c = 0; c < N; c++)
+            {
+                char ch = board[r][c] == '$' ? '$' : inverse[board[r][c] - '1'];
+                if (transpose)
+                {
+                    out[columns[c]][rows[r]] = ch;
+                }
+                else
+                {
+                    out[rows[r]][columns[c]] = ch;
+                }
+            }
+        }
+        return out;
+    }
+};
+
+// Ĺ淶ʽȼۣ±šнйнתãĿӳ䵽ͬһ
+// ΪÿУУһЩ任²ֵֵк͹ڵУк͹ڵУ
+// ٰ״γֵ˳±ţתԼֵͬȡֵСĽ
+// ֵͬйʱֻȡһ֣ʱȼ۵ĿܵõͬĹ淶ʽ任ȷģ
+// ֻήͻʣӰ
+class Canonicalizer
+{
+private:
+    static const int MAX_ORDERS = 64; // Ƚϵ
+
+    // ϺڰѶϳɲ׳ͻֵ
+    static uint32_t mix(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // keys0~2±꣨ȶؼֵͬ±֮
+    static int sortThree(const uint32_t *keys, int order[3])
+    {
+        order[0] = 0, order[1] = 1, order[2] = 2;
+        if (keys[order[1]] < keys[order[0]]) swap(order[0], order[1]);
+        if (keys[order[2]] < keys[order[1]]) swap(order[1], order[2]);
+        if (keys[order[1]] < keys[order[0]]) swap(order[0], order[1]);
+        int same = (keys[order[0]] == keys[order[1]]) + (keys[order[1]] == keys[order[2]]);
+        return same == 0 ? 1 : same == 1 ? 2 : 6;
+    }
+
+    // źsortedöֵֻͬԪصõУ6֣
+    static int tiePermutations(const uint32_t *keys, const int sorted[3], int out[6][3])
+    {
+        int count = 0;
+        int p[3] = {0, 1, 2};
+        do
+        {
+            if (keys[p[0]] == keys[sorted[0]] && keys[p[1]] == keys[sorted[1]] && keys[p[2]] == keys[sorted[2]])
+            {
+                memcpy(out[count++], p, sizeof(p));
+            }
+        } while (next_permutation(p, p + 3));
+        return count;
+    }
+
+    // ÿеֵõȫѡ˳limitʱֻذֵȶһ
+    static int lineOrders(const uint32_t lineKeys[N], int limit, int orders[][N])
+    {
+        uint32_t bandKeys[3] = {0, 0, 0};
+        int inner[3][3];
+        int count = 1;
+        for (int b = 0; b < 3; b++)
+        {
+            count *= sortThree(lineKeys + b * 3, inner[b]);
+            for (int k = 0; k < 3; k++)
+            {
+                bandKeys[b] += mix(lineKeys[b * 3 + k]);
+            }
+        }
+        int bands[3];
+        count *= sortThree(bandKeys, bands);
+
+        if (count == 1 || count > limit) // ûֵͬУйʱֻȡȶĽ
+        {
+            for (int b = 0; b < 3; b++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    orders[0][b * 3 + k] = bands[b] * 3 + inner[bands[b]][k];
+                }
+            }
+            return 1;
+        }
+        int bandChoices[6][3], innerChoices[3][6][3], innerCount[3];
+        int bandCount = tiePermutations(bandKeys, bands, bandChoices);
+        for (int b = 0; b < 3; b++)
+        {
+            innerCount[b] = tiePermutations(lineKeys + b * 3, inner[b], innerChoices[b]);
+        }
+        int n = 0;
+        for (int x = 0; x < bandCount; x++)
+        {
+            const int *band = bandChoices[x];
+            for (int i0 = 0; i0 < innerCount[band[0]]; i0++)
+            {
+                for (int i1 = 0; i1 < innerCount[band[1]]; i1++)
+                {
+                    for (int i2 = 0; i2 < innerCount[band[2]]; i2++)
+                    {
+                        int pick[3] = {i0, i1, i2};
+                        for (int b = 0; b < 3; b++)
+                        {
+                            for (int k = 0; k < 3; k++)
+                            {
+                                orders[n][b * 3 + k] = band[b] * 3 + innerChoices[band[b]][pick[b]][k];
+                            }
+                        }
+                        n++;
+                    }
+                }
+            }
+        }
+        return n;
+    }
+
+public:
+    // boardĹ淶ʽtransformΪboard淶ʽı任
+    static Board canonicalize(const Board &board, BoardTransform &transform)
+    {
+        int digitCount[N] = {0}, rowCount[N] = {0}, columnCount[N] = {0}, blockCount[N] = {0};
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                if (board[i][j] != '$')
+                {
+                    digitCount[board[i][j] - '1']++;
+                    rowCount[i]++;
+                    columnCount[j]++;
+                    blockCount[(i / 3) * 3 + j / 3]++;
+                }
+            }
+        }
+        // еֵɸÿСڹԼֵĳִɣͬ
+        uint32_t rowKeys[N], columnKeys[N];
+        for (int k = 0; k < N; k++)
+        {
+            rowKeys[k] = rowCount[k];
+            columnKeys[k] = columnCount[k];
+        }
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                if (board[i][j] != '$')
+                {
+                    uint32_t common = (digitCount[board[i][j] - '1'] << 8 | blockCount[(i / 3) * 3 + j / 3]) + 1;
+                    uint32_t r = common | columnCount[j] << 4, c = common | rowCount[i] << 4;
+                    rowKeys[i] += r * r * 0x9E3779B1U; // ƽӣʹͬļϲ׵õͬĺ
+                    columnKeys[j] += c * c * 0x9E3779B1U;
+                }
+            }
+        }
+
+        char best[N * N];
+        bool found = false;
+        int rowOrders[MAX_ORDERS][N], columnOrders[MAX_ORDERS][N];
+        for (int transpose = 0; transpose < 2; transpose++)
+        {
+            // תúԭгΪ
+            const uint32_t *lineKeys = transpose ? columnKeys : rowKeys;
+            const uint32_t *crossKeys = transpose ? rowKeys : columnKeys;
+            int rowCountOrders = lineOrders(lineKeys, MAX_ORDERS, rowOrders);
+            int columnCountOrders = lineOrders(crossKeys, MAX_ORDERS / rowCountOrders, columnOrders);
+            for (int x = 0; x < rowCountOrders; x++)
+            {
+                for (int y = 0; y < columnCountOrders; y++)
+                {
+                    // ״γֵ˳±ţһڵǰŽǰ
+                    char label[N];
+                    memset(label, 0, sizeof(label));
+                    char next = '1';
+                    char candidate[N * N];
+                    int cmp = found ? 0 : -1;
+                    for (int r = 0; r < N && cmp <= 0; r++)
+                    {
+                        for (int c = 0; c < N; c++)
+                        {
+                            int i = rowOrders[x][r], j = columnOrders[y][c];
+                            char ch = transpose ? board[j][i] : board[i][j];
+                            if (ch != '$')
+                            {
+                                char &l = label[ch - '1'];
+                                if (!l)
+                                {
+                                    l = next++;
+                                }
+                                ch = l;
+                            }
+                            candidate[r * N + c] = ch;
+                            if (cmp == 0 && ch != best[r * N + c])
+                            {
+                                cmp = ch < best[r * N + c] ? -1 : 1;
+                            }
+                        }
+                    }
+                    if (cmp < 0)
+                    {
+                        memcpy(best, candidate, N * N);
+                        found = true;
+                        transform.transpose = transpose;
+                        for (int k = 0; k < N; k++)
+                        {
+                            transform.rows[k] = rowOrders[x][k];
+                            transform.columns[k] = columnOrders[y][k];
+                        }
+                        // δְֵС˳ں
+                        for (int d = 0; d < N; d++)
+                        {
+                            transform.digits[d] = label[d] ? label[d] : next++;
+                        }
+                    }
+                }
+            }
+        }
+        Board result;
+        memcpy(result.cells, best, N * N);
+        return result;
+    }
+};
+
+struct BoardHash
+{
+    size_t operator()(const Board &board) const
+    {
+        uint64_t h = 1469598103934665603ULL; // FNV-1a
+        for (int k = 0; k < N * N; k++)
+        {
+            h = (h ^ (unsigned char)board.cells[k]) * 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+// Ŀ淶ʽȫ⣨ͬΪ淶ʽĻ棬ڶ֮߳乲
+// ֻMAX_SOLUTIONSĿĿﵽcapacityټµĿ
+class SolutionCache
+{
+private:
+    unordered_map<Board, vector<Board>, BoardHash> entries;
+    mutex lock;
+    size_t capacity;
+
+public:
+    static const int MAX_SOLUTIONS = 16;
+
+    explicit SolutionCache(size_t cap = 1 << 20) : capacity(cap)
+    {
+    }
+
+    bool find(const Board &key, vector<Board> &solutions)
+    {
+        lock_guard<mutex> guard(lock);
+        auto it = entries.find(key);
+        if (it == entries.end())
+        {
+            return false;
+        }
+        solutions = it->second;
+        return true;
+    }
+
+    void insert(const Board &key, const vector<Board> &solutions)
+    {
+        lock_guard<mutex> guard(lock);
+        if (entries.size() < capacity)
+        {
+            entries[key] = solutions;
+        }
+    }
+
+    size_t size()
+    {
+        lock_guard<mutex> guard(lock);
+        return entries.size();
+    }
+
+    // ļΪ̸ʽÿĿ֮ĸ⣨ΪͬһĿ
+    void load(const string &path)
+    {
+        BoardReader reader(path);
+        Board board;
+        vector<Board> *current = NULL;
+        lock_guard<mutex> guard(lock);
+        while (reader.next(board))
+        {
+            if (reader.index() == 0)
+            {
+                current = entries.size() < capacity ? &entries[board] : NULL;
+            }
+            else if (current)
+            {
+                current->push_back(board);
+            }
+        }
+    }
+
+    void save(const string &path)
+    {
+        ofstream out(path.c_str(), ios::out | ios::trunc | ios::binary);
+        BoardWriter writer(out, FORMAT_BINARY);
+        lock_guard<mutex> guard(lock);
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            writer.write(it->first, 0);
+            for (size_t k = 0; k < it->second.size(); k++)
+            {
+                writer.write(it->second[k], k + 1);
+            }
+        }
+    }
+};
+
+// һ̣ÿ⽻visitؽ
+// лʱѻеĽ任ԭ̣⣬ڽδlimitضʱ뻺
+template <class Solver, class Visit>
+int solveCached(Solver &solver, const Board &board, int limit, SolutionCache *cache, Visit visit)
+{
+    if (!cache)
+    {
+        return solver.solveSudoku(board, visit, limit);
+    }
+    BoardTransform transform;
+    Board key = Canonicalizer::canonicalize(board, transform);
+    vector<Board> solutions;
+    if (cache->find(key, solutions))
+    {
+        int count = limit > 0 ? min<int>(limit, solutions.size()) : solutions.size();
+        for (int k = 0; k < count; k++)
+        {
+            visit(transform.invert(solutions[k]));
+        }
+        return count;
+    }
+    bool complete = true;
+    int count = solver.solveSudoku(board, [&](const Board &solution)
+                                   {
+                                       visit(solution);
+                                       if (solutions.size() < SolutionCache::MAX_SOLUTIONS)
+                                       {
+                                           solutions.push_back(transform.apply(solution));
+                                       }
+                                       else
+                                       {
+                                           complete = false;
+                                       }
+                                   },
+                                   limit);
+    if (complete && (limit == 0 || count < limit))
+    {
+        cache->insert(key, solutions);
+    }
+    return count;
+}
+
+// 棺ENGINE_DFSΪSudokuPlayerλENGINE_DLXΪ赸ȷ
+enum SolverEngine
+{
+    ENGINE_DFS,
+    ENGINE_DLX
+};
+
+// ߳ʽ⣺ÿҵֱдwriterκν⣬ڴռ޹
+// ÿlimit⣨0ʾƣıŴ0ʼ
+// statsOutΪNULLʱͬʱÿ̵ͳƣ̱Ŵbaseʼ
+template <class Solver>
+void solveStream(const vector<Board> &boards, BoardWriter &writer, int limit, StatsWriter *statsOut = NULL,
+                 size_t base = 0, SolutionCache *cache = NULL)
+{
+    Solver solver;
+    unique_ptr<bool[]> valid(new bool[boards.size()]);
+    checkBoards(boards.data(), boards.size(), valid.get());
+    for (size_t i = 0; i < boards.size(); i++)
+    {
+        int index = 0;
+        solver.resetStats();
+        if (valid[i])
+        {
+            solveCached(solver, boards[i], limit, cache, [&writer, &index](const Board &solution) { writer.write(solution, index++); });
+        }
+        if (statsOut)
+        {
+            statsOut->add(base + i, boards[i], index, solver.getStats());
+        }
+    }
+}
+
+// ȡأÿ߳Լ˫˶УӶβȡԼ񣨺ȳղֳڻУ
+// ԼĶΪʱ̵߳ĶȡȽȳȡͨǽύģϴ
+// ִʱԼύȫִϺrun
+class TaskPool
+{
+public:
+    typedef function<void(int)> Task; // ΪִиḺ́߳
+
+private:
+    struct Queue
+    {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<Queue> > queues;
+    atomic<size_t> pending; // ύδִ
+    atomic<size_t> queued;  // ڶеȴִе
+    mutex idleLock;
+    condition_variable idle; // ûȡ߳ڴ˵ȴȫʱ
+
+    bool pop(int worker, Task &task)
+    {
+        {
+            Queue &own = *queues[worker];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); k++)
+        {
+            Queue &victim = *queues[(worker + k) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(int worker)
+    {
+        Task task;
+        while (true)
+        {
+            if (pop(worker, task))
+            {
+                task(worker);
+                task = nullptr;
+                if (--pending == 0)
+                {
+                    lock_guard<mutex> guard(idleLock);
+                    idle.notify_all();
+                }
+                continue;
+            }
+            // ʣִУǿֳܻڼ飬pushĻ
+            unique_lock<mutex> guard(idleLock);
+            if (pending == 0)
+            {
+                return;
+            }
+            if (queued == 0)
+            {
+                idle.wait(guard);
+            }
+        }
+    }
+
+public:
+    explicit TaskPool(int threadCount) : pending(0), queued(0)
+    {
+        for (int t = 0; t < max(threadCount, 1); t++)
+        {
+            queues.push_back(unique_ptr<Queue>(new Queue()));
+        }
+    }
+
+    int size() const
+    {
+        return queues.size();
+    }
+
+    // workerĶβ
+    void push(int worker, Task task)
+    {
+        pending++;
+        {
+            Queue &own = *queues[worker];
+            lock_guard<mutex> guard(own.lock);
+            own.tasks.push_back(move(task));
+            queued++;
+        }
+        lock_guard<mutex> guard(idleLock);
+        idle.notify_one();
+    }
+
+    void run()
+    {
+        vector<thread> threads;
+        for (int t = 1; t < size(); t++)
+        {
+            threads.push_back(thread(&TaskPool::work, this, t));
+        }
+        work(0); // ִ߳ͬ
+        for (size_t t = 0; t < threads.size(); t++)
+        {
+            threads[t].join();
+        }
+    }
+};
+
+// ڹȡĶ߳
+// ÿһDFSһ̣ʵĽڵSPLIT_NODESʱֹ
+// չSPLIT_LEVELSΪΪ񹩿߳ȡԿɼ
+// ÿ̵Ľⰴ˳ƴӣ뵥߳Ľ˳ȫͬ
+// ֻȡڽڵ߳͵޹
+// limitʱÿ̹һʣ0δʼֱǰԲlimit
+// ռʱٰ˳ѣ˽˳еǰlimit
+// Ᵽÿ̸߳ԵSolutionArenaУֻ֮òͷţεsolveʱΪڴ
+class BatchSolver
+{
+private:
+    static const long long SPLIT_NODES = 2048;
+    static const int SPLIT_LEVELS = 2;
+
+    // һ̻arenas[worker]дfirstʼcount⣻ֺΪchildrenĽƴ
+    struct SearchNode
+    {
+        int worker;
+        size_t first;
+        size_t count;
+        SolveStats stats;
+        vector<unique_ptr<SearchNode> > children;
+        unique_ptr<SudokuPlayer::Subtree> skipped; // ҵlimitδ
+
+        SearchNode() : worker(0), first(0), count(0)
+        {
+        }
+    };
+
+    struct Puzzle
+    {
+        SearchNode root;
+        bool store;               // δл棬ɺҪ뻺
+        bool deferred;            // 뱾ǰ̵ȼۣǰ̴뻺پǷ
+        BoardTransform transform; // ̵淶ʽı任
+        Board key;                // ̵Ĺ淶ʽ
+
+        Puzzle() : store(false), deferred(false)
+        {
+        }
+    };
+
+    const vector<Board> *boards;
+    SolverEngine engine;
+    int limit;
+    SolutionCache *cache;
+    TaskPool pool;
+    vector<SudokuPlayer> players; // ÿ߳һ
+    vector<DlxSolver> dlx;
+    vector<SolutionArena> arenas; // ÿ߳ҵĽ
+    vector<Puzzle> puzzles;
+    SolutionArena output;         // ˳ռȫ
+    vector<SolutionView> results;
+    unique_ptr<atomic<int>[]> remaining; // ÿ̻ҵĽֻlimit>0ʱʹ
+    size_t remainingSize;
+
+    // лʱѻеĽ任ԭ׷ӵoutУlimit
+    bool findCached(const Puzzle &puzzle, SolutionArena &out)
+    {
+        vector<Board> cached;
+        if (!cache->find(puzzle.key, cached))
+        {
+            return false;
+        }
+        for (size_t k = 0; k < cached.size() && (limit == 0 || k < (size_t)limit); k++)
+        {
+            out.push_back(puzzle.transform.invert(cached[k]));
+        }
+        return true;
+    }
+
+    // orderеĸ̣˳ֳĶη̵߳ĶУԼǶε߳ȥȡ
+    void schedule(const vector<size_t> &order)
+    {
+        for (int t = 0; t < pool.size(); t++)
+        {
+            size_t begin = order.size() * t / pool.size(), end = order.size() * (t + 1) / pool.size();
+            for (size_t k = end; k-- > begin;)
+            {
+                size_t i = order[k];
+                pool.push(t, [this, i](int w) { solveBoard(w, i); });
+            }
+        }
+        pool.run();
+    }
+
+    void solveBoard(int worker, size_t i)
+    {
+        const Board &board = (*boards)[i];
+        Puzzle &puzzle = puzzles[i];
+        SolutionArena &out = arenas[worker];
+        puzzle.root.worker = worker;
+        puzzle.root.first = out.size();
+        if (cache && !puzzle.deferred)
+        {
+            if (findCached(puzzle, out))
+            {
+                puzzle.root.count = out.size() - puzzle.root.first;
+                return;
+            }
+            puzzle.store = true;
+        }
+        if (engine == ENGINE_DLX)
+        {
+            DlxSolver &solver = dlx[worker];
+            solver.resetStats();
+            solver.solveSudoku(board, [&out](const Board &solution) { out.push_back(solution); }, limit);
+            puzzle.root.count = out.size() - puzzle.root.first;
+            puzzle.root.stats = solver.getStats();
+        }
+        else
+        {
+            solveSubtree(worker, SudokuPlayer::rootSubtree(board), &puzzle.root, &remaining[i]);
+        }
+    }
+
+    void solveSubtree(int worker, const SudokuPlayer::Subtree &tree, SearchNode *node, atomic<int> *left)
+    {
+        SudokuPlayer &solver = players[worker];
+        SolutionArena &out = arenas[worker];
+        node->worker = worker;
+        node->first = out.size();
+        if (limit > 0 && *left <= 0)
+        {
+            node->skipped.reset(new SudokuPlayer::Subtree(tree));
+            return;
+        }
+        solver.resetStats();
+        SudokuPlayer::SolutionVisitor visit = [&out, left](const Board &solution)
+        {
+            out.push_back(solution);
+            (*left)--;
+        };
+        if (solver.solveSubtree(tree, visit, limit, SPLIT_NODES) < 0)
+        {
+            *left += (int)(out.size() - node->first);
+            out.truncate(node->first); // ֹǰҵĽ⣬ɲֳҵ
+            vector<SudokuPlayer::Subtree> parts;
+            solver.splitSubtree(tree, SPLIT_LEVELS, parts);
+            for (size_t k = 0; k < parts.size(); k++)
+            {
+                node->children.push_back(unique_ptr<SearchNode>(new SearchNode()));
+            }
+            // β߳ȡ˳ǰ̴߳Ӷȡ
+            for (size_t k = parts.size(); k-- > 0;)
+            {
+                SearchNode *child = node->children[k].get();
+                SudokuPlayer::Subtree part = move(parts[k]);
+                pool.push(worker, [this, part, child, left](int w) { solveSubtree(w, part, child, left); });
+            }
+        }
+        node->count = out.size() - node->first;
+        node->stats = solver.getStats();
+    }
+
+    void collect(size_t i, size_t first, vector<SolveStats> *stats)
+    {
+        SolveStats total;
+        collect(puzzles[i].root, first, total);
+        if (stats)
+        {
+            (*stats)[i] = total;
+        }
+    }
+
+    // ˳nodeĽ׷ӵoutputУÿlimitfirstΪ̵һλ
+    void collect(const SearchNode &node, size_t first, SolveStats &stats)
+    {
+        stats.add(node.stats);
+        if (node.skipped)
+        {
+            // ҵlimit⣬ǰlimit̲߳
+            int need = (int)(first + limit - output.size());
+            if (need > 0)
+            {
+                SudokuPlayer &solver = players[0];
+                solver.resetStats();
+                solver.solveSubtree(*node.skipped, [this](const Board &solution) { output.push_back(solution); }, need);
+                stats.add(solver.getStats());
+            }
+            return;
+        }
+        size_t count = node.count;
+        if (limit > 0)
+        {
+            count = min(count, first + (size_t)limit - output.size());
+        }
+        output.append(arenas[node.worker].view(node.first, count));
+        for (size_t k = 0; k < node.children.size(); k++)
+        {
+            collect(*node.children[k], first, stats);
+        }
+    }
+
+public:
+    BatchSolver(int threadCount, SolverEngine e, int l, SolutionCache *c)
+        : boards(NULL), engine(e), limit(l), cache(c), pool(threadCount), arenas(pool.size()), remainingSize(0)
+    {
+        if (engine == ENGINE_DLX)
+        {
+            dlx.resize(pool.size());
+        }
+        else
+        {
+            players.resize(pool.size());
+        }
+    }
+
+    // ֵĵiΪboards[i]Ľ⣬һεsolve֮ǰЧ
+    // statsΪNULLʱͬʱÿ̵ͳ
+    const vector<SolutionView> &solve(const vector<Board> &input, vector<SolveStats> *stats)
+    {
+        boards = &input;
+        for (size_t t = 0; t < arenas.size(); t++)
+        {
+            arenas[t].reset();
+        }
+        puzzles.clear();
+        puzzles.resize(input.size());
+        if (remainingSize < input.size())
+        {
+            remainingSize = input.size();
+            remaining.reset(new atomic<int>[remainingSize]);
+        }
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            remaining[i] = limit;
+        }
+        unique_ptr<bool[]> valid(new bool[input.size()]);
+        checkBoards(input.data(), input.size(), valid.get());
+        if (cache)
+        {
+            // Ȳ̵Ĺ淶ʽ뱾ǰ̵ȼ۵ݲ⣬
+            // ߳ʱǰһ̴Ļ棬ͬǰһ̰˳뻺ٲ
+            for (int t = 0; t < pool.size(); t++)
+            {
+                size_t begin = input.size() * t / pool.size(), end = input.size() * (t + 1) / pool.size();
+                const bool *ok = valid.get();
+                pool.push(t, [this, ok, begin, end](int)
+                          {
+                              for (size_t i = begin; i < end; i++)
+                              {
+                                  if (ok[i])
+                                  {
+                                      puzzles[i].key = Canonicalizer::canonicalize((*boards)[i], puzzles[i].transform);
+                                  }
+                              }
+                          });
+            }
+            pool.run();
+            unordered_map<Board, size_t, BoardHash> seen;
+            for (size_t i = 0; i < input.size(); i++)
+            {
+                puzzles[i].deferred = valid[i] && !seen.insert(make_pair(puzzles[i].key, i)).second;
+            }
+        }
+        vector<size_t> order;
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            if (valid[i] && !puzzles[i].deferred)
+            {
+                order.push_back(i);
+            }
+        }
+        schedule(order);
+
+        output.reset();
+        vector<size_t> starts(input.size()), counts(input.size());
+        if (stats)
+        {
+            stats->assign(input.size(), SolveStats());
+        }
+        order.clear();
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            starts[i] = output.size();
+            if (puzzles[i].deferred)
+            {
+                // δл˵ǰȼ۵ûд뻺棬뵥߳ʱһֱ
+                if (!findCached(puzzles[i], output))
+                {
+                    order.push_back(i);
+                }
+                counts[i] = output.size() - starts[i];
+                continue;
+            }
+            collect(i, starts[i], stats);
+            counts[i] = output.size() - starts[i];
+            // solveCachedֻͬδlimitضMAX_SOLUTIONS⼯
+            if (puzzles[i].store && (limit == 0 || counts[i] < (size_t)limit) && counts[i] <= SolutionCache::MAX_SOLUTIONS)
+            {
+                vector<Board> canonical;
+                for (size_t k = starts[i]; k < output.size(); k++)
+                {
+                    canonical.push_back(puzzles[i].transform.apply(output[k]));
+                }
+                cache->insert(puzzles[i].key, canonical);
+            }
+        }
+        if (!order.empty())
+        {
+            for (size_t t = 0; t < arenas.size(); t++)
+            {
+                arenas[t].reset();
+            }
+            schedule(order);
+            for (size_t k = 0; k < order.size(); k++)
+            {
+                size_t i = order[k];
+                starts[i] = output.size();
+                collect(i, starts[i], stats);
+                counts[i] = output.size() - starts[i];
+            }
+        }
+        // outputռп·䣬ȫռͼ
+        results.resize(input.size());
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            results[i] = output.view(starts[i], counts[i]);
+        }
+        return results;
+    }
+};
+
+// ߳⣬ֵĵiΪboards[i]Ľ⣨ÿlimit0ʾȫ˳һ
+// statsΪNULLʱͬʱÿ̵ͳƣʱֱʹBatchSolverԸڴ
+vector<vector<Board> > solveBatch(const vector<Board> &boards, int threadCount, SolverEngine engine = ENGINE_DFS,
+                                  int limit = 0, vector<SolveStats> *stats = NULL, SolutionCache *cache = NULL)
+{
+    BatchSolver solver(threadCount, engine, limit, cache);
+    const vector<SolutionView> &views = solver.solve(boards, stats);
+    vector<vector<Board> > results(views.size());
+    for (size_t i = 0; i < views.size(); i++)
+    {
+        results[i].assign(views[i].begin(), views[i].end());
+    }
+    return results;
+}
+
+// ̵ļϣֻÿ̵64λָƣʹÿѰַװʲ1/2
+// 1000000Լռ16MBָͬͬʱֻʹһظɣظ
+class BoardHashSet
+{
+private:
+    vector<uint64_t> slots; // 0ʾλ
+    size_t used;
+
+    static uint64_t fingerprint(const char *cells, size_t n)
+    {
+        uint64_t h = 1469598103934665603ULL; // FNV-1aһλʹλֲ
+        for (size_t k = 0; k < n; k++)
+        {
+            h = (h ^ (unsigned char)cells[k]) * 1099511628211ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h ? h : 1;
+    }
+
+    // ָƣѴʱfalse
+    bool insertFingerprint(uint64_t h)
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t k = h & mask;; k = (k + 1) & mask)
+        {
+            if (slots[k] == h)
+            {
+                return false;
+            }
+            if (slots[k] == 0)
+            {
+                slots[k] = h;
+                used++;
+                return true;
+            }
+        }
+    }
+
+    void grow()
+    {
+        vector<uint64_t> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, 0);
+        used = 0;
+        for (size_t k = 0; k < old.size(); k++)
+        {
+            if (old[k])
+            {
+                insertFingerprint(old[k]);
+            }
+        }
+    }
+
+public:
+    // expectedΪԤƵһԷ㹻Ŀռ
+    explicit BoardHashSet(size_t expected = 0) : used(0)
+    {
+        size_t capacity = 1024;
+        while (capacity < expected * 2)
+        {
+            capacity *= 2;
+        }
+        slots.assign(capacity, 0);
+    }
+
+    // һ̣Ѵʱfalse
+    template <class BoardType>
+    bool insert(const BoardType &board)
+    {
+        if ((used + 1) * 2 > slots.size())
+        {
+            grow();
+        }
+        return insertFingerprint(fingerprint(board.cells, sizeof(board.cells)));
+    }
+
+    size_t size() const
+    {
+        return used;
+    }
+};
+
+// ʱȥأDEDUP_EXACTȥọ̈̄ͬDEDUP_CANONICALȥȼۣ淶ʽͬ
+enum DedupMode
+{
+    DEDUP_NONE,
+    DEDUP_EXACT,
+    DEDUP_CANONICAL
+};
+
+class Deduplicator
+{
+private:
+    BoardHashSet seen;
+    DedupMode mode;
+
+public:
+    Deduplicator(DedupMode m, size_t expected) : seen(expected), mode(m)
+    {
+    }
+
+    // ̣淶ʽǵһγʱtrue¼
+    bool accept(const Board &board)
+    {
+        if (mode == DEDUP_CANONICAL)
+        {
+            BoardTransform transform;
+            return seen.insert(Canonicalizer::canonicalize(board, transform));
+        }
+        return seen.insert(board);
+    }
+
+    // 9x9ֻȫͬȥ
+    template <int BOX>
+    bool accept(const BasicBoard<BOX> &board)
+    {
+        return seen.insert(board);
+    }
+};
+
+// makẹֱõһûгֹ̣dedupΪNULLʱȥأ
+// maxAttemptsζظʱfalse˵Ѿµ
+template <class BoardType, class Make>
+bool generateDistinct(Deduplicator *dedup, BoardType &board, Make make, int maxAttempts = 1000)
+{
+    for (int attempt = 0; attempt < maxAttempts; attempt++)
+    {
+        board = make();
+        if (!dedup || dedup->accept(board))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Options {
+    int completeBoardCount = 0;
+    string inputFile = "";
+    int gameNumber = 0;
+    int gameLevel = 0;
+    vector<int> range;
+    bool uniqueSolution = false;
+    int threadCount = 1;
+    bool hasSeed = false;
+    uint64_t seed = 0;
+    OutputFormat format = FORMAT_TEXT;
+    SolverEngine engine = ENGINE_DFS;
+    int targetScore = 0;
+    string gradeFile = "";
+    int box = 3;
+    int maxSolutions = 0; // ʱÿĽ0ʾȫ
+    string convertFile = "";
+    string statsFile = "";
+    DedupMode dedup = DEDUP_NONE;
+    bool serve = false;
+    string socketPath = ""; // Ϊʱͨ׼ṩ
+    bool useCache = false;
+    string cacheFile = ""; // Ϊʱֻڴ
+};
+Options parse(int argc, char *argv[]) {
+    Options opts;
+    int opt = 0;
+    char *end;
+    static const struct option longOptions[] = {
+        {"seed", required_argument, NULL, 'S'},
+        {"grade", required_argument, NULL, 'G'},
+        {"convert", required_argument, NULL, 'C'},
+        {"stats", required_argument, NULL, 'T'},
+        {"cache", optional_argument, NULL, 'K'},
+        {"dedup", optional_argument, NULL, 'D'},
+        {"serve", optional_argument, NULL, 'V'},
+        {NULL, 0, NULL, 0}};
+    while ((opt = getopt_long(argc, argv, "c:s:n:m:r:uj:f:e:d:b:x:", longOptions, NULL)) != -1)
+    {
+        opt = static_cast<unsigned char>(opt);
+        switch (opt)
+        {
+        case 'c':
+            opts.completeBoardCount = atoi(optarg);
+            if (opts.completeBoardCount < 1 || opts.completeBoardCount > 1000000)
+            {
+                printf("Χ1~1000000֮\n");
+                exit(0);
+            }
+            break;
+        case 's':
+            opts.inputFile = string(optarg);
+            if (access(optarg, 0) == -1)
+            {
+                printf("file does not exist\n");
+                exit(0);
+            }
+            break;
+        case 'n':
+            opts.gameNumber = atoi(optarg);
+            if (opts.gameNumber < 1 || opts.gameNumber > 10000)
+            {
+                printf("ϷΧ1~10000֮\n");
+                exit(0);
+            }
+            break;
+        case 'm':
+            opts.gameLevel = atoi(optarg);
+            if (opts.gameLevel < 1 || opts.gameLevel > 3)
+            {
+                printf("ϷѶȵķΧ1~3֮\n");
+                exit(0);
+            }
+            if(opts.gameNumber == 0){
+                printf("mnһʹ\n");
+                exit(0);
+            }
+            break;
+        case 'r':
+            char *p;
+            p = strtok(optarg, "~");
+            while (p)
+            {
+                opts.range.push_back(atoi(p));
+                p = strtok(NULL, "~");
+            }
+            if (opts.range.size() != 2)
+            {
+                printf("һΧ\n");
+                exit(0);
+            }
+            if ((opts.range[0] >= opts.range[1]) || opts.range[0] < 20 || opts.range[1] > 55)
+            {
+                printf("ϷΧ20~55\n");
+                exit(0);
+            }
+            if(opts.gameNumber == 0){
+                printf("rnһʹ\n");
+                exit(0);
+            }
+            break;
+        case 'u':
+            opts.uniqueSolution = true;
+            if(opts.gameNumber == 0){
+                printf("unһʹ\n");
+                exit(0);
+            }
+            break;
+        case 'j':
+            opts.threadCount = atoi(optarg);
+            if (opts.threadCount < 1 || opts.threadCount > 256)
+            {
+                printf("߳Χ1~256֮\n");
+                exit(0);
+            }
+            break;
+        case 'f':
+            if (strcmp(optarg, "text") == 0)
+            {
+                opts.format = FORMAT_TEXT;
+            }
+            else if (strcmp(optarg, "line") == 0)
+            {
+                opts.format = FORMAT_LINE;
+            }
+            else if (strcmp(optarg, "bin") == 0)
+            {
+                opts.format = FORMAT_BINARY;
+            }
+            else
+            {
+                printf("ʽֻΪtextlinebin\n");
+                exit(0);
+            }
+            break;
+        case 'e':
+            if (strcmp(optarg, "dfs") == 0)
+            {
+                opts.engine = ENGINE_DFS;
+            }
+            else if (strcmp(optarg, "dlx") == 0)
+            {
+                opts.engine = ENGINE_DLX;
+            }
+            else
+            {
+                printf("ֻΪdfsdlx\n");
+                exit(0);
+            }
+            break;
+        case 'd':
+            opts.targetScore = atoi(optarg);
+            if (opts.targetScore < 1 || opts.targetScore > 10000)
+            {
+                printf("ĿѶȷֵķΧ1~10000֮\n");
+                exit(0);
+            }
+            if(opts.gameNumber == 0){
+                printf("dnһʹ\n");
+                exit(0);
+            }
+            break;
+        case 'b':
+            opts.box = atoi(optarg);
+            if (opts.box < 2 || opts.box > 5)
+            {
+                printf("ı߳Χ2~5֮\n");
+                exit(0);
+            }
+            break;
+        case 'x':
+            opts.maxSolutions = atoi(optarg);
+            if (opts.maxSolutions < 1)
+            {
+                printf("ÿĽΪ1\n");
+                exit(0);
+            }
+            break;
+        case 'G':
+            opts.gradeFile = string(optarg);
+            if (access(optarg, 0) == -1)
+            {
+                printf("file does not exist\n");
+                exit(0);
+            }
+            break;
+        case 'C':
+            opts.convertFile = string(optarg);
+            if (access(optarg, 0) == -1)
+            {
+                printf("file does not exist\n");
+                exit(0);
+            }
+            break;
+        case 'T':
+            if (!SUDOKU_STATS)
+            {
+                printf("ʱδͳƣSUDOKU_STATSΪ0\n");
+                exit(0);
+            }
+            opts.statsFile = string(optarg);
+            break;
+        case 'D':
+            if (optarg == NULL || strcmp(optarg, "exact") == 0)
+            {
+                opts.dedup = DEDUP_EXACT;
+            }
+            else if (strcmp(optarg, "canon") == 0)
+            {
+                opts.dedup = DEDUP_CANONICAL;
+            }
+            else
+            {
+                printf("ȥطʽֻΪexactcanon\n");
+                exit(0);
+            }
+            break;
+        case 'V':
+            opts.serve = true;
+            opts.socketPath = optarg ? string(optarg) : "";
+#ifdef _WIN32
+            if (!opts.socketPath.empty())
+            {
+                printf("ƽ̨֧Unix׽֣ʹñ׼\n");
+                exit(0);
+            }
+#endif
+            break;
+        case 'K':
+            opts.useCache = true;
+            opts.cacheFile = optarg ? string(optarg) : "";
+            break;
+        case 'S':
+            opts.seed = strtoull(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0')
+            {
+                printf("ӱǷǸ\n");
+                exit(0);
+            }
+            opts.hasSeed = true;
+            break;
+        default:
+            printf("Ϸ\n");
+            exit(0);
+            break;
+        }
+    }
+    // -xͬʱ-s--serveڶȫټ飬Ⱥ˳޹
+    if (opts.maxSolutions > 0 && opts.inputFile.empty() && !opts.serve)
+    {
+        printf("xsserveһʹ\n");
+        exit(0);
+    }
+    // ߳Ϊ˳Ҫȱÿ̵ȫ⣬ƽʱڴռû
+    if (opts.threadCount > 1 && !opts.inputFile.empty() && opts.maxSolutions == 0)
+    {
+        printf("߳⣨j1ʱòxÿ̵Ľ\n");
+        exit(0);
+    }
+    return opts;
+}
 
-const int N = 9;
 
-class SudokuPlayer
+
+
+// ̿ڿ⣬ÿֻ81
+// generateBoard(0)getRand9copySquareõһ̣ҹ˳͹˳
+// ٰ±ʹһΪ123456789Ϊ̡k±idx = (start + k * stride) % TOTAL
+//   idx % ROW_ORDERS 2~9еУ1й̶2*2*6*6֣
+//   idx / ROW_ORDERS ֵ±ţ9!֣ǡõ̵ĵһ
+// ̵ĸлͬ˲ͬ±һọ̃ͬstrideTOTALʣǰTOTALظ
+class CompleteBoardGenerator
 {
 private:
-    // ʹλʾĳǷֹ
-    // rowUsed[i] ʾiʹù֣columnUsed[j]ʾjʹù֣blockUsed[k]ʾk3x3ʹù
-    int rowUsed[N];
-    int columnUsed[N];
-    int blockUsed[N];
+    static const int ROW_ORDERS = 2 * 2 * 6 * 6;
+    static const uint64_t TOTAL = 362880ULL * ROW_ORDERS; // 9! * ROW_ORDERS
 
-public:
-    vector<Board> result;           //洢ļ
-    vector<pair<int, int> > spaces; // 洢пոλ
+    int base[N][N]; // ̣Ϊ0~8
+    uint64_t start, stride, produced;
 
-public:
-    SudokuPlayer()
+    static uint64_t gcd(uint64_t a, uint64_t b)
     {
-        initState();
+        return b == 0 ? a : gcd(b, a % b);
     }
 
-    void initState()
+public:
+    explicit CompleteBoardGenerator(SudokuPlayer &player) : produced(0)
     {
-        memset(rowUsed, 0, sizeof(rowUsed));
-        memset(columnUsed, 0, sizeof(columnUsed));
-        memset(blockUsed, 0, sizeof(blockUsed));
-        spaces.clear();
-        result.clear();
+        static const int perms[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+        Board board = player.generateBoard(0);
+        // йԼÿڵ
+        int columns[N];
+        int stack = player.randInt(6);
+        for (int s = 0; s < 3; s++)
+        {
+            int inner = player.randInt(6);
+            for (int c = 0; c < 3; c++)
+            {
+                columns[s * 3 + c] = perms[stack][s] * 3 + perms[inner][c];
+            }
+        }
+        // ±ţʹ̵һΪ0~8
+        int label[N];
+        for (int j = 0; j < N; j++)
+        {
+            label[board[0][columns[j]] - '1'] = j;
+        }
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                base[i][j] = label[board[i][columns[j]] - '1'];
+            }
+        }
+        start = ((uint64_t)player.randInt(1 << 30) << 30 | player.randInt(1 << 30)) % TOTAL;
+        stride = ((uint64_t)player.randInt(1 << 30) << 30 | player.randInt(1 << 30)) % TOTAL;
+        while (gcd(stride, TOTAL) != 1)
+        {
+            stride++;
+        }
     }
 
-    void addResult(Board &board)
+    // ɵĻͬ
+    static uint64_t capacity()
     {
-        vector<vector<char> > obj(board);
-        result.push_back(obj);
+        return TOTAL;
     }
 
-    //iСjСӦ3x3еdigitתdigitΪʹ״̬Ϊδʹã֮Ȼ
-    void flip(int i, int j, int digit)
+    // һ̣ócapacity()κῪʼظ
+    void next(Board &board)
     {
-        rowUsed[i] ^= (1 << digit);
-        columnUsed[j] ^= (1 << digit);
-        blockUsed[(i / 3) * 3 + j / 3] ^= (1 << digit);
-    }
+        static const int perms[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+        static const int factorial[N] = {40320, 5040, 720, 120, 24, 6, 2, 1, 1};
+        uint64_t idx = (start + (produced++ % TOTAL) * stride) % TOTAL;
+        int order = idx % ROW_ORDERS;
+        int code = idx / ROW_ORDERS;
+
+        // еУһڽ23УУԼڸԵ
+        int rows[N];
+        rows[0] = 0;
+        rows[1] = 1 + order % 2;
+        rows[2] = 2 - order % 2;
+        order /= 2;
+        int band1 = 1 + order % 2, band2 = 2 - order % 2;
+        order /= 2;
+        for (int r = 0; r < 3; r++)
+        {
+            rows[3 + r] = band1 * 3 + perms[order % 6][r];
+            rows[6 + r] = band2 * 3 + perms[order / 6][r];
+        }
+
+        // ɿչı뻹ԭֵ±
+        char digits[N];
+        int unused = 0x1FF;
+        for (int d = 0; d < N; d++)
+        {
+            int q = code / factorial[d];
+            code %= factorial[d];
+            int mask = unused;
+            for (int k = 0; k < q; k++)
+            {
+                mask &= mask - 1;
+            }
+            int digit = __builtin_ctz(mask);
+            unused ^= 1 << digit;
+            digits[d] = '1' + digit;
+        }
 
-    vector<Board> solveSudoku(Board board)
-    {
-        initState();
         for (int i = 0; i < N; i++)
         {
+            const int *src = base[rows[i]];
+            char *dst = board[i];
             for (int j = 0; j < N; j++)
             {
-                if (board[i][j] == '$') // Ϊ'$'ʾ˸ΪգҪ
-                {
-                    spaces.push_back(pair<int, int>(i, j));
-                }
-                else // 򣬸ССʹ
-                {
-                    int digit = board[i][j] - '1';
-                    flip(i, j, digit);
-                }
+                dst[j] = digits[src[j]];
             }
         }
-        DFS(board, 0);
-        return result;
     }
+};
 
-    void DFS(Board &board, int pos)
+// ʹCompleteBoardGeneratorcounṭͬɵɸõĻд
+// dedupΪNULLʱѾ
+void generateCompleteBoards(int count, ofstream &outfile, SudokuPlayer &player, OutputFormat format = FORMAT_TEXT,
+                            Deduplicator *dedup = NULL)
+{
+    CompleteBoardGenerator generator(player);
+    BoardWriter writer(outfile, format);
+    vector<Board> boards(4096);
+    bool valid[4096];
+    for (int begin = 0; begin < count; begin += boards.size())
     {
-        if (pos == spaces.size()) // пλʱ״̬Ϊһ
+        int n = min<int>(boards.size(), count - begin);
+        for (int i = 0; i < n; i++)
         {
-            addResult(board);
-            return;
+            if (!generateDistinct(dedup, boards[i], [&generator]() { Board b; generator.next(b); return b; }))
+            {
+                printf("޷ɸ໥̣ͬ%d\n", begin + i);
+                n = i;
+                count = 0;
+                break;
+            }
         }
-        int i = spaces[pos].first, j = spaces[pos].second;
-        for (int digit = 0; digit < N; digit++) // ڿոпܵ
+        checkBoards(boards.data(), n, valid);
+        for (int i = 0; i < n; i++)
         {
-            // жڵiСjСӦ3x3digitǷѾʹùʹù룬Գ
-            if ((rowUsed[i] & (1 << digit)) || (columnUsed[j] & (1 << digit)) || (blockUsed[(i / 3) * 3 + j / 3] & (1 << digit)))
+            if (!valid[i])
             {
-                continue;
+                cout << "wrong board" << endl;
             }
-            flip(i, j, digit); // ССʹ
-            board[i][j] = '1' + digit; // 
-            DFS(board, pos + 1); // һո
-            flip(i, j, digit); // ָССʹл
-            board[i][j] = '$'; // ָ״̬л
+            writer.write(boards[i], 0);
         }
     }
+    writer.flush();
+    outfile.close();
+}
+
+// ڿΧֵڿ
+template <int BOX>
+int pickDigCount(const vector<int> &digCount, BasicSudokuPlayer<BOX> &player)
+{
+    if (digCount.size() == 1)
+    {
+        return digCount[0];
+    }
+    return player.randInt(digCount[1] - digCount[0] + 1) + digCount[0];
+}
 
-    void getResult()
+// һѶȷֲtargetScoreϷೢmaxAttemptsΣﲻʱѶȷߵһ
+Board generateGradedBoard(int cnt, int targetScore, SudokuPlayer &player, SudokuGrader &grader, int maxAttempts = 100)
+{
+    Board best;
+    int bestScore = -1;
+    for (int attempt = 0; attempt < maxAttempts; attempt++)
     {
-        for (size_t i = 0; i < result.size(); i++)
+        Board b = player.generateBoard(cnt);
+        Grade g = grader.grade(b);
+        if (g.score >= targetScore)
+        {
+            return b;
+        }
+        if (g.score > bestScore)
         {
-            Board board = result[i];
-            printBoard(board);
+            best = b;
+            bestScore = g.score;
         }
     }
+    return best;
+}
 
-    bool checkBoard(Board &board)
+// һȥcntӵΨһϷΨһڿչ̱֤Ҫٴ
+// ڲcntʱgenerateBoardɣﱣԭĽӿ
+template <int BOX>
+BasicBoard<BOX> generateUniqueBoard(int cnt, BasicSudokuPlayer<BOX> &player, int maxAttempts = 20)
+{
+    return player.generateBoard(cnt, NULL, maxAttempts);
+}
+
+// statsOutΪNULLʱÿϷͳƣԣɵϷΨһ
+// dedupΪNULLʱظϷᱻ
+void generateGame(int gameNumber, int gameLevel, vector<int> digCount, ofstream &outfile, SudokuPlayer &player,
+                  OutputFormat format = FORMAT_TEXT, int targetScore = 0, StatsWriter *statsOut = NULL,
+                  Deduplicator *dedup = NULL)
+{
     {
-        initState();
-        for (int i = 0; i < N; i++)
+        BoardWriter writer(outfile, format);
+        SudokuGrader grader;
+        for (int i = 0; i < gameNumber; i++)
         {
-            for (int j = 0; j < N; j++)
+            player.resetStats();
+            Board board;
+            if (!generateDistinct(dedup, board, [&]()
+                                  {
+                                      int cnt = pickDigCount(digCount, player);
+                                      return targetScore > 0 ? generateGradedBoard(cnt, targetScore, player, grader) : player.generateBoard(cnt);
+                                  }))
             {
-                // 㵱ǰϵַ֣תΪ
-                if (board[i][j] != '$' && board[i][j] != '.')
-                {
-                    int digit = board[i][j] - '1';
-
-                    // 鵱ǰǷڵСл߿Ѿʹù
-                    // ʹλ飺ӦλѾΪ1ôΪ0Ϊtrue
-                    // ʹλ|еʹ״̬Ȼʹλ루&ضλ
-                    if ((rowUsed[i] | columnUsed[j] | blockUsed[(i / 3) * 3 + j / 3]) & (1 << digit))
-                    {
-                        return false;
-                    }
-                    flip(i, j, digit);
-                }
+                printf("޷ɸ໥ͬϷ%d\n", i);
+                break;
+            }
+            writer.write(board, 0);
+            if (statsOut)
+            {
+                statsOut->add(i, board, 1, player.getStats());
             }
         }
-        return true;
     }
-
-    void printBoard(Board &board)
+    outfile.close();
+}
+void generateGameU(int gameNumber, int gameLevel, const vector<int>& digCount, ofstream& outfile, SudokuPlayer& player,
+                   OutputFormat format = FORMAT_TEXT, int targetScore = 0, StatsWriter *statsOut = NULL,
+                   Deduplicator *dedup = NULL)
+{
     {
-        for (int i = 0; i < board.size(); i++)
+        BoardWriter writer(outfile, format);
+        SudokuGrader grader;
+        for (int i = 0; i < gameNumber; i++)
         {
-            for (int j = 0; j < board[i].size(); j++)
+            player.resetStats();
+            Board board;
+            if (!generateDistinct(dedup, board, [&]()
+                                  {
+                                      int cnt = pickDigCount(digCount, player);
+                                      // ڿʱѱ֤Ψһ⣬ѶȷɸѡõͬΨһ
+                                      return targetScore > 0 ? generateGradedBoard(cnt, targetScore, player, grader) : generateUniqueBoard(cnt, player);
+                                  }))
             {
-                cout << board[i][j] << " ";
+                printf("޷ɸ໥ͬϷ%d\n", i);
+                break;
+            }
+            writer.write(board, 0);
+            if (statsOut)
+            {
+                statsOut->add(i, board, 1, player.getStats());
             }
-            cout << "\n";
         }
     }
 
-    vector<int> getRand9()
+    outfile.close();
+}
+
+// ߳Ϸÿ߳ӵжSudokuPlayerʹͬseeḏֵ߳
+// Ϸɣÿڵt̸߳һΣд˳̵߳޹أ
+// ͬseedthreadCountǵõͬȥдʱ˳УظϷɵ0̵߳SudokuPlayer
+void generateGameParallel(int gameNumber, int gameLevel, const vector<int> &digCount, bool unique,
+                          int threadCount, uint64_t seed, ofstream &outfile, OutputFormat format = FORMAT_TEXT,
+                          int targetScore = 0, StatsWriter *statsOut = NULL, Deduplicator *dedup = NULL)
+{
+    BoardWriter writer(outfile, format);
+    const int batchSize = 4096 * threadCount; // ÿϷһԱȫ
+    vector<SudokuPlayer> players(threadCount);
+    for (int t = 0; t < threadCount; t++)
+    {
+        players[t].seed(seed, t);
+    }
+    auto makeGame = [&](SudokuPlayer &player, SudokuGrader &grader)
+    {
+        int cnt = pickDigCount(digCount, player);
+        if (targetScore > 0)
+            return generateGradedBoard(cnt, targetScore, player, grader);
+        return unique ? generateUniqueBoard(cnt, player) : player.generateBoard(cnt);
+    };
+    SudokuGrader mainGrader;
+    vector<Board> boards;
+    vector<SolveStats> stats;
+    for (int begin = 0; begin < gameNumber; begin += batchSize)
     {
-        // ʹC++11random_device
-        // std::random_device rd;
-        // std::mt19937 g(rd());
+        int count = min(batchSize, gameNumber - begin);
+        boards.resize(count);
+        stats.resize(count);
+        auto worker = [&](int t)
+        {
+            SudokuGrader grader;
+            for (int i = (long long)count * t / threadCount; i < (long long)count * (t + 1) / threadCount; i++)
+            {
+                players[t].resetStats();
+                boards[i] = makeGame(players[t], grader);
+                stats[i] = players[t].getStats();
+            }
+        };
+        vector<thread> threads;
+        for (int t = 1; t < threadCount; t++)
+        {
+            threads.push_back(thread(worker, t));
+        }
+        worker(0);
+        for (size_t t = 0; t < threads.size(); t++)
+        {
+            threads[t].join();
+        }
+        for (int i = 0; i < count; i++)
+        {
+            if (dedup && !dedup->accept(boards[i]))
+            {
+                players[0].resetStats();
+                if (!generateDistinct(dedup, boards[i], [&]() { return makeGame(players[0], mainGrader); }))
+                {
+                    printf("޷ɸ໥ͬϷ%d\n", begin + i);
+                    writer.flush();
+                    outfile.close();
+                    return;
+                }
+                stats[i] = players[0].getStats();
+            }
+            writer.write(boards[i], 0);
+            if (statsOut)
+            {
+                statsOut->add(begin + i, boards[i], 1, stats[i]);
+            }
+        }
+    }
+    writer.flush();
+    outfile.close();
+}
 
-        // ʹõǰϵͳʱ
-        auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-        mt19937 g(seed);
-        // ʼһ08
-        vector<int> result(9);
-        iota(result.begin(), result.end(), 0); 
+// ļĴ򿪷ʽƸʽзת
+ios::openmode outputMode(OutputFormat format)
+{
+    return format == FORMAT_BINARY ? ios::out | ios::trunc | ios::binary : ios::out | ios::trunc;
+}
 
-        // ʹshuffle
-        
-        shuffle(result.begin(), result.end(), g);
-        return result;
+// ѶȼõڿΧ9x9̵81ƣ
+vector<int> levelRange(int gameLevel)
+{
+    vector<int> range;
+    // ݲͬȡڿͬ
+    if (gameLevel == 1) {
+        range.push_back(20);
+        range.push_back(30);
+    } else if (gameLevel == 2) {
+        range.push_back(30);
+        range.push_back(40);
+    } else if (gameLevel == 3) {
+        range.push_back(40);
+        range.push_back(55);
+    } else {
+        range.push_back(20);
+        range.push_back(55);
+    }
+    return range;
+}
+
+// δָ-rʱ-mѶȼڿΧ
+void defaultRange(Options &opts)
+{
+    if (opts.range.empty()) {
+        opts.range = levelRange(opts.gameLevel);
+    }
+}
+
+// 9x9-bָı֧߳⣨-sϷ-n-m-r-uΪ߳
+// -m-rڿ9x9̼ƣȱ㵽ʵʳߴ
+template <int BOX>
+void runSized(Options &opts, uint64_t seed)
+{
+    typedef BasicBoard<BOX> SizedBoard;
+    const int cells = BOX * BOX * BOX * BOX;
+    BasicSudokuPlayer<BOX> player;
+    player.seed(seed);
+    ofstream outfile;
+    unique_ptr<StatsWriter> statsOut(opts.statsFile.empty() ? NULL : new StatsWriter(opts.statsFile));
+
+    if (!opts.inputFile.empty()) {
+        outfile.open("sudoku.txt", outputMode(opts.format));
+        BasicBoardReader<BOX> reader(opts.inputFile);
+        BasicBoardWriter<BOX> writer(outfile, opts.format);
+        SizedBoard board;
+        for (size_t k = 0; reader.next(board); k++) {
+            int index = 0;
+            player.resetStats();
+            if (player.checkBoard(board)) {
+                player.solveSudoku(board, [&writer, &index](const SizedBoard &solution) { writer.write(solution, index++); },
+                                   opts.maxSolutions);
+            }
+            if (statsOut) statsOut->add(k, board, index, player.getStats());
+        }
+        writer.flush();
+        outfile.close();
+    }
+
+    if (opts.gameNumber > 0) {
+        defaultRange(opts);
+        vector<int> digCount;
+        for (size_t k = 0; k < opts.range.size(); k++) {
+            digCount.push_back(opts.range[k] * cells / 81);
+        }
+        outfile.open("game.txt", outputMode(opts.format));
+        {
+            BasicBoardWriter<BOX> writer(outfile, opts.format);
+            unique_ptr<Deduplicator> dedup(opts.dedup == DEDUP_NONE ? NULL : new Deduplicator(opts.dedup, opts.gameNumber));
+            for (int i = 0; i < opts.gameNumber; i++) {
+                player.resetStats();
+                SizedBoard board;
+                if (!generateDistinct(dedup.get(), board, [&]() {
+                        int cnt = pickDigCount(digCount, player);
+                        return opts.uniqueSolution ? generateUniqueBoard(cnt, player) : player.generateBoard(cnt);
+                    })) {
+                    printf("޷ɸ໥ͬϷ%d\n", i);
+                    break;
+                }
+                writer.write(board, 0);
+                if (statsOut) statsOut->add(i, board, 1, player.getStats());
+            }
+        }
+        outfile.close();
     }
-    Board generateBoard(int digCount)
+}
+
+// ģʽפжȡһӦͻ֮临
+// ÿһ
+//   <81ַĿ>                 ⣬ȼsolve
+//   solve <81ַĿ> [] Ӧ"ok <> <1> <2> ..."ÿΪ81ַ
+//                                    ޣ-xĬ100
+//   gen [Ѷ1~3] []             ΨһϷӦ"ok <> <Ŀ1> ..."
+//   grade <81ַĿ>           ѶȣӦ"ok <Ѷȷ> <Ѽ>"
+//   quit                             ӣ׼ʱ̣
+// ʱӦ"err <ԭ>"
+class SudokuServer
+{
+private:
+    static const int DEFAULT_MAX_SOLUTIONS = 100; // δָʱĬޣ̵޷
+
+    SudokuPlayer player;
+    DlxSolver dlx;
+    SudokuGrader grader;
+    SolverEngine engine;
+    int maxSolutions;
+    SolutionCache *cache;
+
+    // 81ַĿ'.''0''$'ʾո
+    static bool parseBoard(const char *text, Board &board)
     {
-        vector<vector<char>> board(N, vector<char>(N, '$'));
-        vector<int> row = getRand9();
-        for (int i = 0; i < 3; i++)
+        if (strlen(text) != N * N)
         {
-            board[3][i + 3] = row[i] + '1';
-            board[4][i + 3] = row[i + 3] + '1';
-            board[5][i + 3] = row[i + 6] + '1';
+            return false;
         }
-        copySquare(board, 3, 3, true);
-        copySquare(board, 3, 3, false);
-        copySquare(board, 3, 0, false);
-        copySquare(board, 3, 6, false);
-
-        while (digCount)
+        for (int k = 0; k < N * N; k++)
         {
-            int x = rand() % 9;
-            int y = rand() % 9;
-            if (board[x][y] == '$')
-                continue;
-            char tmp = board[x][y];
-            board[x][y] = '$';
-
-            solveSudoku(board);
-            if (result.size() == 1)
+            char c = text[k];
+            if ('1' <= c && c <= '9')
+            {
+                board.cells[k] = c;
+            }
+            else if (c == '.' || c == '0' || c == '$')
             {
-                digCount--;
+                board.cells[k] = '$';
             }
             else
             {
-                board[x][y] = tmp;
+                return false;
             }
         }
-        // printBoard(board);
-        // cout << "spaces " << player.spaces.size() << "\n";
-        if (!checkBoard(board))
-        {
-            cout << "wrong board" << endl;
-        }
-
-        return board;
+        return true;
     }
 
-    
-
-    void copySquare(Board &board, int src_x, int src_y, bool isRow)
+    // ӦеĿոͳһд'.'
+    static void appendBoard(string &response, const Board &board)
     {
-        // Ƶ˳
-        int rand_tmp = rand() % 2 + 1;
-        int order_first[3] = {1, 2, 0};
-        int order_second[3] = {2, 0, 1};
-        if (rand_tmp == 2)
+        response += ' ';
+        for (int k = 0; k < N * N; k++)
         {
-            order_first[0] = 2;
-            order_first[1] = 0;
-            order_first[2] = 1;
-            order_second[0] = 1;
-            order_second[1] = 2;
-            order_second[2] = 0;
+            response += board.cells[k] == '$' ? '.' : board.cells[k];
         }
+    }
 
-        // ̽иƺ͵
-        for (int i = 0; i < 3; i++)
+    void solve(const char *text, int limit, string &response)
+    {
+        Board board;
+        bool valid = false;
+        if (!parseBoard(text, board) || (checkBoards(&board, 1, &valid), !valid))
         {
-            int order[2][3] = { {order_first[0], order_first[1], order_first[2]}, {order_second[0], order_second[1], order_second[2]} };
-            for (int j = 0; j < 2; j++)
-            {
-                for (int k = 0; k < 3; k++)
-                {
-                    if (isRow)
-                    {
-                        board[src_x + k][i + j * 6] = board[src_x + order[j][k]][src_y + i];
-                    }
-                    else
-                    {
-                        board[i + j * 6][src_y + k] = board[src_x + i][src_y + order[j][k]];
-                    }
-                }
-            }
+            response = "err invalid puzzle";
+            return;
         }
+        string solutions;
+        auto visit = [&solutions](const Board &solution) { appendBoard(solutions, solution); };
+        int count = engine == ENGINE_DLX ? solveCached(dlx, board, limit, cache, visit)
+                                         : solveCached(player, board, limit, cache, visit);
+        response = "ok " + to_string(count) + solutions;
     }
-};
-char data[9][9] = {
-    {'5', '3', '.', '.', '7', '.', '.', '.', '.'},
-    {'6', '.', '.', '1', '9', '5', '.', '.', '.'},
-    {'.', '9', '8', '.', '.', '.', '.', '6', '.'},
-    {'8', '.', '.', '.', '6', '.', '.', '.', '3'},
-    {'4', '.', '.', '8', '.', '3', '.', '.', '1'},
-    {'7', '.', '.', '.', '2', '.', '.', '.', '6'},
-    {'.', '6', '.', '.', '.', '.', '2', '8', '.'},
-    {'.', '.', '.', '4', '1', '9', '.', '.', '5'},
-    {'.', '.', '.', '.', '8', '.', '.', '7', '9'}};
-
-void test()
-{
-    SudokuPlayer player;
-    vector<vector<char> > board(N, vector<char>(N, '.'));
 
-    for (int i = 0; i < board.size(); i++)
+    void generate(int level, int count, string &response)
     {
-        for (int j = 0; j < board[i].size(); j++)
+        vector<int> range = levelRange(level);
+        response = "ok " + to_string(count);
+        for (int i = 0; i < count; i++)
         {
-            board[i][j] = data[i][j];
+            appendBoard(response, generateUniqueBoard(pickDigCount(range, player), player));
         }
     }
-    bool check = player.checkBoard(board);
-    if (check)
-        cout << "checked" << endl;
-
-    player.solveSudoku(board);
-    player.getResult();
-
-    cout << endl;
-}
 
-vector<Board> readFile(string filePath)
-{
-    ifstream infile;
-    vector<Board> boards;
-    infile.open(filePath);
-    char data[100];
-    Board tmp;
-    vector<char> row;
-    while (!infile.eof())
+    void grade(const char *text, string &response)
     {
-        infile.getline(data, 100);
-        if (data[0] == '-')
+        Board board;
+        if (!parseBoard(text, board))
         {
-            boards.push_back(Board(tmp));
-            tmp.clear();
-            continue;
+            response = "err invalid puzzle";
+            return;
         }
-        for (int i = 0; i < strlen(data); i++)
+        Grade g = grader.grade(board);
+        if (!g.valid)
         {
-            if (('1' <= data[i] && data[i] <= '9') || data[i] == '$')
-            {
-                row.push_back(data[i]);
-            }
+            response = "err invalid puzzle";
+            return;
         }
-        tmp.push_back(vector<char>(row));
-        row.clear();
+        response = "ok " + to_string(g.score) + " " + TECHNIQUE_NAMES[g.hardest];
     }
-    infile.close();
-    return boards;
-}
 
-void writeFile(vector<Board> boards, ofstream &f)
-{
-    for (int k = 0; k < boards.size(); k++)
+public:
+    SudokuServer(SolverEngine e, int limit, uint64_t seed, uint64_t stream, SolutionCache *c)
+        : engine(e), maxSolutions(limit > 0 ? limit : DEFAULT_MAX_SOLUTIONS), cache(c)
     {
-        for (int i = 0; i < boards[k].size(); i++)
-        {
-            for (int j = 0; j < boards[k][i].size(); j++)
-            {
-                f << boards[k][i][j] << " ";
-            }
-            f << "\n";
-        }
-        f << "------- " << k << " -------" << endl;
+        player.seed(seed, stream);
     }
-}
 
-struct Options {
-    int completeBoardCount = 0;
-    string inputFile = "";
-    int gameNumber = 0;
-    int gameLevel = 0;
-    vector<int> range;
-    bool uniqueSolution = false;
-};
-Options parse(int argc, char *argv[]) {
-    Options opts;
-    int opt = 0;
-    while ((opt = getopt(argc, argv, "c:s:n:m:r:u")) != -1)
+    // һ󣬷falseʾ
+    bool handle(char *line, string &response)
     {
-        opt = static_cast<unsigned char>(opt);
-        switch (opt)
+        char *argv[4] = {NULL, NULL, NULL, NULL};
+        int argc = 0;
+        for (char *p = strtok(line, " \t\r\n"); p && argc < 4; p = strtok(NULL, " \t\r\n"))
         {
-        case 'c':
-            opts.completeBoardCount = atoi(optarg);
-            if (opts.completeBoardCount < 1 || opts.completeBoardCount > 1000000)
-            {
-                printf("Χ1~1000000֮\n");
-                exit(0);
-            }
-            break;
-        case 's':
-            opts.inputFile = string(optarg);
-            if (access(optarg, 0) == -1)
-            {
-                printf("file does not exist\n");
-                exit(0);
-            }
-            break;
-        case 'n':
-            opts.gameNumber = atoi(optarg);
-            if (opts.gameNumber < 1 || opts.gameNumber > 10000)
+            argv[argc++] = p;
+        }
+        if (argc == 0)
+        {
+            response = "err empty request";
+        }
+        else if (strcmp(argv[0], "quit") == 0)
+        {
+            return false;
+        }
+        else if (strcmp(argv[0], "solve") == 0 && argc >= 2)
+        {
+            // еܳ
+            int limit = argc >= 3 ? atoi(argv[2]) : maxSolutions;
+            solve(argv[1], limit > 0 ? min(limit, maxSolutions) : maxSolutions, response);
+        }
+        else if (strcmp(argv[0], "gen") == 0)
+        {
+            int level = argc >= 2 ? atoi(argv[1]) : 0;
+            int count = argc >= 3 ? atoi(argv[2]) : 1;
+            if (level < 0 || level > 3 || count < 1 || count > 10000)
             {
-                printf("ϷΧ1~10000֮\n");
-                exit(0);
+                response = "err invalid generate request";
             }
-            break;
-        case 'm':
-            opts.gameLevel = atoi(optarg);
-            if (opts.gameLevel < 1 || opts.gameLevel > 3)
+            else
             {
-                printf("ϷѶȵķΧ1~3֮\n");
-                exit(0);
-            }
-            if(opts.gameNumber == 0){
-                printf("mnһʹ\n");
-                exit(0);
+                generate(level, count, response);
             }
-            break;
-        case 'r':
-            char *p;
-            p = strtok(optarg, "~");
-            while (p)
+        }
+        else if (strcmp(argv[0], "grade") == 0 && argc >= 2)
+        {
+            grade(argv[1], response);
+        }
+        else if (argc == 1 && strlen(argv[0]) == N * N)
+        {
+            solve(argv[0], maxSolutions, response);
+        }
+        else
+        {
+            response = "err unknown request";
+        }
+        response += '\n';
+        return true;
+    }
+
+    // inжȡÿӦдͨwrite
+    // ȵжֻظһδ󣬶Ǳسɶ
+    template <class Write>
+    void serve(FILE *in, Write write)
+    {
+        vector<char> line(1 << 16);
+        string response;
+        while (fgets(line.data(), line.size(), in))
+        {
+            size_t len = strlen(line.data());
+            if (len == line.size() - 1 && line[len - 1] != '\n')
             {
-                opts.range.push_back(atoi(p));
-                p = strtok(NULL, "~");
+                int c;
+                while ((c = fgetc(in)) != EOF && c != '\n')
+                {
+                }
+                response = "err request too long\n";
             }
-            if (opts.range.size() != 2)
+            else if (!handle(line.data(), response))
             {
-                printf("һΧ\n");
-                exit(0);
+                break;
             }
-            if ((opts.range[0] >= opts.range[1]) || opts.range[0] < 20 || opts.range[1] > 55)
+            if (!write(response))
             {
-                printf("ϷΧ20~55\n");
-                exit(0);
-            }
-            if(opts.gameNumber == 0){
-                printf("rnһʹ\n");
-                exit(0);
+                break;
             }
-            break;
-        case 'u':
-            opts.uniqueSolution = true;
-            if(opts.gameNumber == 0){
-                printf("unһʹ\n");
-                exit(0);
-            }
-            break;
-        default:
-            printf("Ϸ\n");
-            exit(0);
-            break;
         }
     }
-    return opts;
-}
-
-
+};
 
+// ͨ׼ṩ
+void serveStdio(SolverEngine engine, int maxSolutions, uint64_t seed, SolutionCache *cache)
+{
+    SudokuServer server(engine, maxSolutions, seed, 0, cache);
+    server.serve(stdin, [](const string &response)
+                 {
+                     fwrite(response.data(), 1, response.size(), stdout);
+                     return fflush(stdout) == 0;
+                 });
+}
 
-void generateGame(int gameNumber, int gameLevel, vector<int> digCount, ofstream &outfile, SudokuPlayer &player)
+#ifndef _WIN32
+// Unix׽pathṩthreadCount̸߳ԳһSudokuServer
+// νӲϵȫͬһӿͶ
+void serveSocket(const string &path, SolverEngine engine, int maxSolutions, int threadCount, uint64_t seed,
+                 SolutionCache *cache)
 {
-    for (int i = 0; i < gameNumber; i++)
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
     {
-        int cnt = 0;
-        if (digCount.size() == 1)
-        {
-            cnt = digCount[0];
-        }
-        else
-        {
-            cnt = rand() % (digCount[1] - digCount[0] + 1) + digCount[0];
-        }
-        Board b = player.generateBoard(cnt);
-        vector<Board> bs;
-        bs.push_back(b);
-        writeFile(bs, outfile);
+        printf("׽·\n");
+        exit(0);
     }
-    outfile.close();
-}
-void generateGameU(int gameNumber, int gameLevel, const vector<int>& digCount, ofstream& outfile, SudokuPlayer& player)
-{
-    for (int i = 0; i < gameNumber; i++)
+    strcpy(addr.sun_path, path.c_str());
+    // ֻɾϴ׽ļɾͬͨļ
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0)
     {
-        int cnt = 0;
-        if (digCount.size() == 1)
+        if (!S_ISSOCK(st.st_mode))
         {
-            cnt = digCount[0];
-        }
-        else
-        {
-            cnt = rand() % (digCount[1] - digCount[0] + 1) + digCount[0];
+            printf("%sѴҲ׽\n", path.c_str());
+            exit(0);
         }
-
-        Board b;
-        vector<Board> bs;
-
-        while (true)
+        unlink(path.c_str());
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || ::bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0)
+    {
+        printf("޷׽%s\n", path.c_str());
+        exit(0);
+    }
+    signal(SIGPIPE, SIG_IGN); // ͻǰϿʱwriteش󣬶ǽ
+    auto worker = [&](int t)
+    {
+        SudokuServer server(engine, maxSolutions, seed, t, cache);
+        for (;;)
         {
-            b = player.generateBoard(cnt);
-            bs.clear();
-            bs.push_back(b);
-
-            vector<Board> solutions = player.solveSudoku(b);
-            if (solutions.size() == 1)
+            int fd = accept(listener, NULL, NULL);
+            if (fd < 0)
             {
-                break; // Ψһ⣬˳ѭ
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+                {
+                    // Դʱ㣬ȴӹرպٽӣת
+                    this_thread::sleep_for(chrono::milliseconds(100));
+                    continue;
+                }
+                printf("ʧܣ%s\n", strerror(errno));
+                exit(0);
+            }
+            FILE *in = fdopen(fd, "r");
+            if (in == NULL)
+            {
+                close(fd);
+                continue;
             }
-            // 
+            server.serve(in, [fd](const string &response)
+                         {
+                             for (size_t sent = 0; sent < response.size();)
+                             {
+                                 ssize_t n = write(fd, response.data() + sent, response.size() - sent);
+                                 if (n <= 0)
+                                 {
+                                     return false;
+                                 }
+                                 sent += n;
+                             }
+                             return true;
+                         });
+            fclose(in);
         }
-
-        writeFile(bs, outfile);
+    };
+    vector<thread> threads;
+    for (int t = 1; t < threadCount; t++)
+    {
+        threads.push_back(thread(worker, t));
     }
-
-    outfile.close();
+    worker(0);
 }
+#endif
 
+// SUDOKU_NO_MAINԽļΪУܲԣ
+#ifndef SUDOKU_NO_MAIN
 int main(int argc, char *argv[]) {
-    srand((unsigned)time(NULL));
     SudokuPlayer player;
 
     Options opts = parse(argc, argv);
+    // ָ--seedʱɹ̿ȫ֣ʹõǰϵͳʱΪ
+    uint64_t seed = opts.hasSeed ? opts.seed : (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    player.seed(seed);
+
+    if (opts.box != 3) {
+        if (opts.completeBoardCount > 0 || !opts.gradeFile.empty() || opts.targetScore > 0 ||
+            opts.engine != ENGINE_DFS || opts.threadCount > 1 || !opts.convertFile.empty() || opts.useCache ||
+            opts.serve) {
+            printf("bֻsnmrufxһʹ\n");
+            exit(0);
+        }
+        if (opts.dedup == DEDUP_CANONICAL) {
+            printf("淶ʽȥֻ֧9x9\n");
+            exit(0);
+        }
+        if (opts.box > 3 && opts.format == FORMAT_BINARY) {
+            printf("Ƹʽֻ֧4x49x9\n");
+            exit(0);
+        }
+        if (opts.box == 2) runSized<2>(opts, seed);
+        else if (opts.box == 4) runSized<4>(opts, seed);
+        else runSized<5>(opts, seed);
+        return 0;
+    }
+
+    if (opts.serve) {
+        // --serveפ񣬲дsudoku.txtļ
+        unique_ptr<SolutionCache> cache(opts.useCache ? new SolutionCache() : NULL);
+        if (opts.socketPath.empty()) serveStdio(opts.engine, opts.maxSolutions, seed, cache.get());
+#ifndef _WIN32
+        else serveSocket(opts.socketPath, opts.engine, opts.maxSolutions, opts.threadCount, seed, cache.get());
+#endif
+        return 0;
+    }
 
     vector<Board> boards;
     ofstream outfile;
+    // --statsɵͳ
+    unique_ptr<StatsWriter> statsOut(opts.statsFile.empty() ? NULL : new StatsWriter(opts.statsFile));
 
     if (!opts.inputFile.empty()) {
-        outfile.open("sudoku.txt", ios::out | ios::trunc);
-        boards = readFile(opts.inputFile);
-        for (int i = 0; i < boards.size(); i++) {
-            vector<Board> result = player.solveSudoku(boards[i]);
-            writeFile(result, outfile);
+        outfile.open("sudoku.txt", outputMode(opts.format));
+        // ȡ⣬⵱ǰεͬʱں̨ȡһڴռֻδСй
+        const size_t batchSize = 4096 * opts.threadCount;
+        BoardReader reader(opts.inputFile);
+        BoardWriter writer(outfile, opts.format);
+        reader.nextBatch(boards, batchSize);
+        size_t base = 0; // ǰεһ̵ı
+        vector<SolveStats> stats;
+        unique_ptr<BatchSolver> batchSolver; // ߳ʱڸ֮临ãĴ洢ֻòͷ
+        // --cacheȼ۵ĿֻһΣָļʱȶļеĻ棬д
+        unique_ptr<SolutionCache> cache(opts.useCache ? new SolutionCache() : NULL);
+        if (cache && !opts.cacheFile.empty() && access(opts.cacheFile.c_str(), 0) != -1) {
+            cache->load(opts.cacheFile);
+        }
+        while (!boards.empty()) {
+            future<vector<Board> > pending = async(launch::async, [&reader, batchSize]() {
+                vector<Board> batch;
+                reader.nextBatch(batch, batchSize);
+                return batch;
+            });
+            if (opts.threadCount == 1) {
+                // ߳ʱֱд߳ʱΪ˳Ҫȱÿ̵Ľ⣨-xƣ
+                if (opts.engine == ENGINE_DLX) solveStream<DlxSolver>(boards, writer, opts.maxSolutions, statsOut.get(), base, cache.get());
+                else solveStream<SudokuPlayer>(boards, writer, opts.maxSolutions, statsOut.get(), base, cache.get());
+            } else {
+                if (!batchSolver) batchSolver.reset(new BatchSolver(opts.threadCount, opts.engine, opts.maxSolutions, cache.get()));
+                const vector<SolutionView> &results = batchSolver->solve(boards, statsOut ? &stats : NULL);
+                for (size_t i = 0; i < results.size(); i++) {
+                    writer.write(results[i]);
+                    if (statsOut) statsOut->add(base + i, boards[i], results[i].size(), stats[i]);
+                }
+            }
+            base += boards.size();
+            boards = pending.get();
+        }
+        writer.flush();
+        outfile.close();
+        if (cache && !opts.cacheFile.empty()) {
+            cache->save(opts.cacheFile);
+        }
+    }
+
+    if (!opts.convertFile.empty()) {
+        // ʽתԶʶĸʽ룬-fָĸʽдÿ̵ı
+        outfile.open("convert.txt", outputMode(opts.format));
+        BoardReader reader(opts.convertFile);
+        BoardWriter writer(outfile, opts.format);
+        Board board;
+        while (reader.next(board)) {
+            writer.write(board, reader.index());
+        }
+        writer.flush();
+        outfile.close();
+    }
+
+    if (!opts.gradeFile.empty()) {
+        // ļе̣ÿѶȷֺõѼ
+        outfile.open("grade.txt", ios::out | ios::trunc);
+        BoardReader reader(opts.gradeFile);
+        SudokuGrader grader;
+        Board board;
+        while (reader.next(board)) {
+            Grade g = grader.grade(board);
+            if (g.valid) outfile << g.score << " " << TECHNIQUE_NAMES[g.hardest] << "\n";
+            else outfile << "-1 invalid\n";
         }
         outfile.close();
     }
 
     if (opts.completeBoardCount > 0) {
-        outfile.open("game.txt", ios::out | ios::trunc);
-        opts.range.push_back(0);
-        generateGame(opts.completeBoardCount, 0, opts.range, outfile, player);
-        opts.range.clear();
+        outfile.open("game.txt", outputMode(opts.format));
+        // ɵ̶ͬһ̱任淶ʽȥֻܵõһֻȫͬȥ
+        unique_ptr<Deduplicator> dedup(opts.dedup == DEDUP_NONE ? NULL : new Deduplicator(DEDUP_EXACT, opts.completeBoardCount));
+        generateCompleteBoards(opts.completeBoardCount, outfile, player, opts.format, dedup.get());
     }
 
     if (opts.gameNumber > 0) {
-        if (opts.range.empty()) {
-            // ݲͬȡڿͬ
-            if (opts.gameLevel == 1) {
-                opts.range.push_back(20);
-                opts.range.push_back(30);
-            } else if (opts.gameLevel == 2) {
-                opts.range.push_back(30);
-                opts.range.push_back(40);
-            } else if (opts.gameLevel == 3) {
-                opts.range.push_back(40);
-                opts.range.push_back(55);
-            } else {
-                opts.range.push_back(20);
-                opts.range.push_back(55);
-            }
-        }
+        defaultRange(opts);
 
-        outfile.open("game.txt", ios::out | ios::trunc);
-        if(opts.uniqueSolution) generateGameU(opts.gameNumber, opts.gameLevel, opts.range, outfile, player);
-        else generateGame(opts.gameNumber, opts.gameLevel, opts.range, outfile, player);
+        outfile.open("game.txt", outputMode(opts.format));
+        // --dedup֤Ϸͬcanonʱȼۣ
+        unique_ptr<Deduplicator> dedup(opts.dedup == DEDUP_NONE ? NULL : new Deduplicator(opts.dedup, opts.gameNumber));
+        if (opts.threadCount > 1) generateGameParallel(opts.gameNumber, opts.gameLevel, opts.range, opts.uniqueSolution, opts.threadCount, seed, outfile, opts.format, opts.targetScore, statsOut.get(), dedup.get());
+        else if(opts.uniqueSolution) generateGameU(opts.gameNumber, opts.gameLevel, opts.range, outfile, player, opts.format, opts.targetScore, statsOut.get(), dedup.get());
+        else generateGame(opts.gameNumber, opts.gameLevel, opts.range, outfile, player, opts.format, opts.targetScore, statsOut.get(), dedup.get());
         opts.range.clear();
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
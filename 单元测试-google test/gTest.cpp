@@ -50,7 +50,7 @@ TEST(SudokuPlayerTest, SolveSudoku)
     SudokuPlayer player;
 
     // 创建一个需要解决的数独棋盘
-    Board board = {
+    Board board = toBoard(LegacyBoard{
         {'5', '3', '$', '$', '7', '$', '$', '$', '$'},
         {'6', '$', '$', '1', '9', '5', '$', '$', '$'},
         {'$', '9', '8', '$', '$', '$', '$', '6', '$'},
@@ -60,10 +60,10 @@ TEST(SudokuPlayerTest, SolveSudoku)
         {'$', '6', '$', '$', '$', '$', '2', '8', '$'},
         {'$', '$', '$', '4', '1', '9', '$', '$', '5'},
         {'$', '$', '$', '$', '8', '$', '$', '7', '9'}
-    };
+    });
 
     // 调用 SudokuPlayer 的 solveSudoku 函数解决数独
-    std::vector<Board> solutions = player.solveSudoku(board);
+    SolutionView solutions = player.solveSudoku(board);
 
     // 断言解决方案的数量为 1，即解决方案是唯一的
     EXPECT_EQ(solutions.size(), 1);
@@ -76,7 +76,7 @@ TEST(SudokuPlayerTest, AddResult)
     SudokuPlayer player;
 
     // 创建一个棋盘对象
-    Board board = {
+    Board board = toBoard(LegacyBoard{
         {'1', '2', '3', '4', '5', '6', '7', '8', '9'},
         {'4', '5', '6', '7', '8', '9', '1', '2', '3'},
         {'7', '8', '9', '1', '2', '3', '4', '5', '6'},
@@ -86,13 +86,13 @@ TEST(SudokuPlayerTest, AddResult)
         {'3', '4', '5', '6', '7', '8', '9', '1', '2'},
         {'6', '7', '8', '9', '1', '2', '3', '4', '5'},
         {'9', '1', '2', '3', '4', '5', '6', '7', '8'}
-    };
+    });
 
     // 调用 SudokuPlayer 的 addResult 函数
     player.addResult(board);
 
     // 获取结果集合
-    vector<Board> result = player.getResult();
+    const SolutionArena &result = player.result;
 
     // 验证结果集合是否包含刚刚添加的棋盘对象
     EXPECT_EQ(result.size(), 1);
@@ -101,7 +101,7 @@ TEST(SudokuPlayerTest, AddResult)
 TEST(CheckBoardTest, ValidBoard) {
     // 创建一个数独棋盘
     SudokuPlayer player;
-    Board board = {
+    Board board = toBoard(LegacyBoard{
         {'5', '3', '.', '.', '7', '.', '.', '.', '.'},
         {'6', '.', '.', '1', '9', '5', '.', '.', '.'},
         {'.', '9', '8', '.', '.', '.', '.', '6', '.'},
@@ -111,7 +111,7 @@ TEST(CheckBoardTest, ValidBoard) {
         {'.', '6', '.', '.', '.', '.', '2', '8', '.'},
         {'.', '.', '.', '4', '1', '9', '.', '.', '5'},
         {'.', '.', '.', '.', '8', '.', '.', '7', '9'}
-    };
+    });
 
     // 调用 checkBoard 函数进行测试
     bool result = player.checkBoard(board);
@@ -123,7 +123,7 @@ TEST(CheckBoardTest, ValidBoard) {
 TEST(CheckBoardTest, InvalidBoard) {
     // 创建一个数独棋盘（无效）
     SudokuPlayer player;
-    Board board = {
+    Board board = toBoard(LegacyBoard{
         {'5', '3', '.', '.', '7', '.', '.', '.', '.'},
         {'6', '.', '.', '1', '9', '5', '.', '.', '.'},
         {'.', '9', '8', '.', '.', '.', '.', '6', '.'},
@@ -133,7 +133,7 @@ TEST(CheckBoardTest, InvalidBoard) {
         {'.', '6', '.', '.', '.', '.', '2', '8', '.'},
         {'.', '.', '.', '4', '1', '9', '.', '.', '5'},
         {'.', '.', '.', '.', '8', '.', '8', '7', '9'} // 重复的数字 '8'
-    };
+    });
 
     // 调用 checkBoard 函数进行测试
     bool result = player.checkBoard(board);
@@ -182,10 +182,36 @@ TEST(GenerateBoardTest, InvalidBoard) {
     ASSERT_NE(countFilledCells(result), 20); // 检查生成的数独棋盘中已填数字的数量是否正确
 }
 
+// 16x16棋盘挖空较多时个别唯一解检查极慢，有节点数上限后应能在有限时间内生成唯一解的题目
+TEST(GenerateBoardTest, SixteenBySixteen)
+{
+    typedef BasicSudokuPlayer<4> Player16;
+    Player16 player;
+    player.seed(1);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int dug = 0;
+    Player16::Board board = player.generateBoard(170, &dug);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_LT(seconds, 60.0);
+
+    int holes = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        for (int j = 0; j < 16; j++)
+        {
+            holes += board[i][j] == '$';
+        }
+    }
+    EXPECT_GT(dug, 0);
+    EXPECT_EQ(holes, dug);
+    EXPECT_TRUE(player.checkBoard(board));
+    EXPECT_EQ(player.solveSudoku(board, [](const Player16::Board &) {}, 2), 1); // 挖空后仍是唯一解
+}
+
 TEST(CopySquareTest, ValidCopy)
 {
     SudokuPlayer player;
-    Board board(N, vector<char>(N, '$')); // 创建一个空的数独棋盘
+    Board board; // 创建一个空的数独棋盘
 
     vector<int> row = player.getRand9();
     for (int i = 0; i < 3; i++)
@@ -207,7 +233,7 @@ TEST(CopySquareTest, ValidCopy)
 TEST(CopySquareTest, InvalidCopy)
 {
     SudokuPlayer player;
-    Board board(N, vector<char>(N, '$')); // 创建一个空的数独棋盘
+    Board board; // 创建一个空的数独棋盘
 
     vector<int> row = player.getRand9();
     for (int i = 0; i < 3; i++)
@@ -226,6 +252,584 @@ TEST(CopySquareTest, InvalidCopy)
     // 示例断言检查，检查复制后的棋盘中某个位置的值是否符合预期
     ASSERT_EQ(board[0][3], '$'); // 检查复制后的棋盘中特定位置的值是否正确
 }
+// 由81个字符的题目得到棋盘，'.'表示空格
+Board parseLine(const char *line)
+{
+    Board board;
+    for (int k = 0; k < N * N; k++)
+    {
+        board.cells[k] = line[k] == '.' ? '$' : line[k];
+    }
+    return board;
+}
+
+// 解的集合，不考虑顺序
+std::vector<Board> sortedSolutions(SolutionView solutions)
+{
+    std::vector<Board> sorted(solutions.begin(), solutions.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+// 测试用的题目：唯一解的难题、去掉几个数字后有多个解的题目，以及固定种子生成的题目
+std::vector<Board> testCorpus()
+{
+    const char *puzzles[] = {
+        "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+        "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+        "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+        "1....7.9..3..2...8..96..5.....3..9...1..8...26....4...3......1..4......7..7...3..",
+        "8..........36......7..9.2...5...7.......457.....1...3...1....6...85...1..9....4..",
+    };
+    std::vector<Board> corpus;
+    for (size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); i++)
+    {
+        corpus.push_back(parseLine(puzzles[i]));
+    }
+    SudokuPlayer player;
+    player.seed(20230629);
+    for (int i = 0; i < 20; i++)
+    {
+        corpus.push_back(player.generateBoard(30 + i));
+    }
+    return corpus;
+}
+
+// 舞蹈链与回溯搜索求得的解的集合应完全相同
+TEST(DlxSolverTest, SameSolutionsAsDfs)
+{
+    std::vector<Board> corpus = testCorpus();
+    SudokuPlayer player;
+    DlxSolver dlx;
+    size_t multiple = 0;
+    for (size_t i = 0; i < corpus.size(); i++)
+    {
+        std::vector<Board> expected = sortedSolutions(player.solveSudoku(corpus[i]));
+        std::vector<Board> actual = sortedSolutions(dlx.solveSudoku(corpus[i]));
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(actual, expected) << "puzzle " << i;
+        multiple += expected.size() > 1;
+    }
+    EXPECT_GT(multiple, 0u); // 语料中至少有一个多解的题目
+}
+
+// 限制解的数量时两种引擎都只返回limit个解
+TEST(DlxSolverTest, SolutionLimit)
+{
+    Board empty;
+    SudokuPlayer player;
+    DlxSolver dlx;
+    int count = 0;
+    EXPECT_EQ(player.solveSudoku(empty, [&count](const Board &) { count++; }, 50), 50);
+    EXPECT_EQ(count, 50);
+    count = 0;
+    EXPECT_EQ(dlx.solveSudoku(empty, [&count](const Board &) { count++; }, 50), 50);
+    EXPECT_EQ(count, 50);
+}
+
+// 按行优先顺序搜索（关闭MRV）得到的解的集合与默认模式相同
+TEST(SudokuPlayerTest, SameSolutionsWithoutMRV)
+{
+    std::vector<Board> corpus = testCorpus();
+    SudokuPlayer player, rowOrder;
+    rowOrder.setMRV(false);
+    for (size_t i = 0; i < corpus.size(); i++)
+    {
+        std::vector<Board> expected = sortedSolutions(player.solveSudoku(corpus[i]));
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(sortedSolutions(rowOrder.solveSudoku(corpus[i])), expected) << "puzzle " << i;
+    }
+}
+
+// 关闭约束传播（以及同时关闭MRV）后得到的解的集合与默认模式相同
+TEST(SudokuPlayerTest, SameSolutionsWithoutPropagation)
+{
+    std::vector<Board> corpus = testCorpus();
+    SudokuPlayer player, noPropagation, plain;
+    noPropagation.setPropagation(false);
+    plain.setPropagation(false);
+    plain.setMRV(false);
+    for (size_t i = 0; i < corpus.size(); i++)
+    {
+        std::vector<Board> expected = sortedSolutions(player.solveSudoku(corpus[i]));
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(sortedSolutions(noPropagation.solveSudoku(corpus[i])), expected) << "puzzle " << i;
+        EXPECT_EQ(sortedSolutions(plain.solveSudoku(corpus[i])), expected) << "puzzle " << i << ", row order";
+    }
+}
+
+// 文本格式写出编号很大的棋盘再读回：缓冲区只够一个棋盘，记录大小估计不足时会越界（使用-fsanitize=address编译可以直接发现）
+template <int BOX>
+void checkLargeIndexRecords()
+{
+    const int SIZE = BOX * BOX;
+    const int indices[] = {0, 9, 99999, 100000, 1234567, 2147483647};
+    const int count = sizeof(indices) / sizeof(indices[0]);
+    BasicSudokuPlayer<BOX> player;
+    player.seed(BOX);
+    std::vector<BasicBoard<BOX> > boards;
+    const char *path = "test_large_index.txt";
+    {
+        std::ofstream out(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        BasicBoardWriter<BOX> writer(out, FORMAT_TEXT, 1);
+        for (int k = 0; k < count; k++)
+        {
+            boards.push_back(player.generateBoard(0));
+            writer.write(boards.back(), indices[k]);
+        }
+    }
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    size_t expected = 0;
+    for (int k = 0; k < count; k++)
+    {
+        expected += SIZE * (2 * SIZE + 1) + std::to_string(indices[k]).size() + 17;
+    }
+    EXPECT_EQ((size_t)in.tellg(), expected) << "BOX " << BOX;
+    in.close();
+
+    BasicBoardReader<BOX> reader(path);
+    BasicBoard<BOX> board;
+    for (int k = 0; k < count; k++)
+    {
+        ASSERT_TRUE(reader.next(board)) << "BOX " << BOX;
+        EXPECT_EQ(board, boards[k]) << "BOX " << BOX;
+        EXPECT_EQ(reader.index(), indices[k]) << "BOX " << BOX;
+    }
+    EXPECT_FALSE(reader.next(board));
+    remove(path);
+}
+
+TEST(BoardWriterTest, LargeIndexRecords)
+{
+    checkLargeIndexRecords<2>();
+    checkLargeIndexRecords<3>();
+    checkLargeIndexRecords<4>();
+    checkLargeIndexRecords<5>();
+}
+
+// 分隔行中超出int范围的编号不能溢出，整个棋盘按格式错误忽略，前后的棋盘不受影响
+TEST(BoardReaderTest, OverlongIndex)
+{
+    const char *separators[] = {"------- 7 -------", "------- 99999999999 -------", "------- 2147483648 -------",
+                                "------- 2147483647 -------"};
+    SudokuPlayer player;
+    player.seed(18);
+    std::vector<Board> boards;
+    const char *path = "test_overlong_index.txt";
+    {
+        std::ofstream out(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        for (int k = 0; k < 4; k++)
+        {
+            boards.push_back(player.generateBoard(0));
+            for (int i = 0; i < 9; i++)
+            {
+                out << std::string(boards[k][i], boards[k][i] + 9) << "\n";
+            }
+            out << separators[k] << "\n";
+        }
+    }
+    BoardReader reader(path);
+    Board board;
+    ASSERT_TRUE(reader.next(board));
+    EXPECT_EQ(board, boards[0]);
+    EXPECT_EQ(reader.index(), 7);
+    ASSERT_TRUE(reader.next(board));
+    EXPECT_EQ(board, boards[3]);
+    EXPECT_EQ(reader.index(), 2147483647);
+    EXPECT_FALSE(reader.next(board));
+    remove(path);
+}
+
+// 二进制格式：单个记录编码后解码得到原棋盘和同一题目标记，整个文件写出再读回后棋盘、编号和文件头中的数量都一致
+template <int BOX>
+void checkBinaryRoundTrip()
+{
+    typedef BinaryFormat<BOX> Binary;
+    BasicSudokuPlayer<BOX> player;
+    player.seed(18 + BOX);
+    std::vector<BasicBoard<BOX> > boards;
+    std::vector<int> indices;
+    for (int k = 0; k < 30; k++)
+    {
+        boards.push_back(player.generateBoard(k % 2 == 0 ? 0 : player.randInt(BOX * BOX * BOX * 2)));
+        indices.push_back(k % 3 == 0 ? 0 : indices.back() + 1); // 每3个棋盘为同一题目的多个解
+    }
+    boards.push_back(BasicBoard<BOX>()); // 全空的棋盘
+
+    for (size_t k = 0; k < boards.size(); k++)
+    {
+        unsigned char record[Binary::RECORD_SIZE];
+        BasicBoard<BOX> decoded;
+        Binary::encode(boards[k], k % 2 == 1, record);
+        EXPECT_EQ(Binary::decode(record, decoded), k % 2 == 1);
+        EXPECT_EQ(decoded, boards[k]) << "BOX " << BOX << " board " << k;
+    }
+
+    const char *path = "test_round_trip.bin";
+    {
+        std::ofstream out(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        BasicBoardWriter<BOX> writer(out, FORMAT_BINARY, 64); // 缓冲区很小，文件头会被多次改写
+        for (size_t k = 0; k + 1 < boards.size(); k++)
+        {
+            writer.write(boards[k], indices[k]);
+        }
+        writer.write(boards.back(), 0);
+    }
+    std::ifstream in(path, std::ios::binary);
+    unsigned char header[Binary::HEADER_SIZE];
+    in.read((char *)header, sizeof(header));
+    EXPECT_TRUE(Binary::isHeader((const char *)header));
+    EXPECT_EQ(header[5], BOX);
+    uint64_t count = 0;
+    for (int k = 7; k >= 0; k--)
+    {
+        count = (count << 8) | header[8 + k];
+    }
+    EXPECT_EQ(count, boards.size());
+    in.seekg(0, std::ios::end);
+    EXPECT_EQ((size_t)in.tellg(), Binary::HEADER_SIZE + boards.size() * Binary::RECORD_SIZE);
+    in.close();
+
+    BasicBoardReader<BOX> reader(path);
+    BasicBoard<BOX> board;
+    for (size_t k = 0; k + 1 < boards.size(); k++)
+    {
+        ASSERT_TRUE(reader.next(board));
+        EXPECT_EQ(board, boards[k]) << "BOX " << BOX << " board " << k;
+        EXPECT_EQ(reader.index(), indices[k]);
+    }
+    ASSERT_TRUE(reader.next(board));
+    EXPECT_EQ(board, boards.back());
+    EXPECT_EQ(reader.index(), 0);
+    EXPECT_FALSE(reader.next(board));
+    remove(path);
+}
+
+TEST(BinaryFormatTest, RoundTrip)
+{
+    checkBinaryRoundTrip<2>();
+    checkBinaryRoundTrip<3>();
+}
+
+// 文本格式转为二进制格式再转回，与原文件逐字节相同
+TEST(BinaryFormatTest, TextBinaryText)
+{
+    SudokuPlayer player;
+    player.seed(2018);
+    {
+        std::ofstream out("test_text.txt", std::ios::out | std::ios::trunc | std::ios::binary);
+        BoardWriter writer(out, FORMAT_TEXT);
+        for (int k = 0; k < 100; k++)
+        {
+            writer.write(player.generateBoard(k % 60), k % 4);
+        }
+    }
+    {
+        std::ofstream out("test_text.bin", std::ios::out | std::ios::trunc | std::ios::binary);
+        BoardWriter writer(out, FORMAT_BINARY);
+        BoardReader reader("test_text.txt");
+        Board board;
+        while (reader.next(board))
+        {
+            writer.write(board, reader.index());
+        }
+    }
+    {
+        std::ofstream out("test_text2.txt", std::ios::out | std::ios::trunc | std::ios::binary);
+        BoardWriter writer(out, FORMAT_TEXT);
+        BoardReader reader("test_text.bin");
+        Board board;
+        while (reader.next(board))
+        {
+            writer.write(board, reader.index());
+        }
+    }
+    std::ifstream a("test_text.txt", std::ios::binary), b("test_text2.txt", std::ios::binary);
+    std::string textA((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+    std::string textB((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+    EXPECT_FALSE(textA.empty());
+    EXPECT_EQ(textA, textB);
+    a.close();
+    b.close();
+    remove("test_text.txt");
+    remove("test_text.bin");
+    remove("test_text2.txt");
+}
+
+// 随机的等价变换：转置、宫行宫列交换、宫内行列交换、数字重新编号
+BoardTransform randomTransform(Pcg32 &rng)
+{
+    BoardTransform t;
+    t.transpose = rng.below(2) == 1;
+    int bands[3] = {0, 1, 2}, stacks[3] = {0, 1, 2};
+    std::shuffle(bands, bands + 3, rng);
+    std::shuffle(stacks, stacks + 3, rng);
+    for (int x = 0; x < 3; x++)
+    {
+        int inRows[3] = {0, 1, 2}, inColumns[3] = {0, 1, 2};
+        std::shuffle(inRows, inRows + 3, rng);
+        std::shuffle(inColumns, inColumns + 3, rng);
+        for (int k = 0; k < 3; k++)
+        {
+            t.rows[x * 3 + k] = bands[x] * 3 + inRows[k];
+            t.columns[x * 3 + k] = stacks[x] * 3 + inColumns[k];
+        }
+    }
+    int digits[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::shuffle(digits, digits + 9, rng);
+    for (int d = 0; d < 9; d++)
+    {
+        t.digits[d] = '1' + digits[d];
+    }
+    return t;
+}
+
+// 规范形式与变换无关，返回的变换把棋盘映射到规范形式，其逆变换映射回原棋盘
+TEST(CanonicalizerTest, InvariantUnderSymmetry)
+{
+    SudokuPlayer player;
+    player.seed(2021);
+    Pcg32 rng;
+    rng.seed(2021, 1);
+    for (int i = 0; i < 300; i++)
+    {
+        Board board = player.generateBoard(20 + player.randInt(36));
+        BoardTransform symmetry = randomTransform(rng);
+        Board variant = symmetry.apply(board);
+        EXPECT_EQ(symmetry.invert(variant), board);
+
+        BoardTransform t1, t2;
+        Board c1 = Canonicalizer::canonicalize(board, t1);
+        Board c2 = Canonicalizer::canonicalize(variant, t2);
+        EXPECT_EQ(c1, c2) << "board " << i;
+        EXPECT_EQ(t1.apply(board), c1);
+        EXPECT_EQ(t1.invert(c1), board);
+        EXPECT_EQ(t2.apply(variant), c2);
+        EXPECT_EQ(t2.invert(c2), variant);
+    }
+}
+
+// 求解等价题目时命中缓存，逆变换回来的解是该题目自己的解
+TEST(CanonicalizerTest, CachedSolutionsMapBack)
+{
+    SudokuPlayer player;
+    player.seed(21);
+    Pcg32 rng;
+    rng.seed(21, 1);
+    SolutionCache cache;
+    for (int i = 0; i < 50; i++)
+    {
+        Board board = player.generateBoard(40 + player.randInt(16));
+        Board variant = randomTransform(rng).apply(board);
+        std::vector<Board> first, second;
+        solveCached(player, board, 0, &cache, [&first](const Board &b) { first.push_back(b); });
+        size_t entries = cache.size();
+        solveCached(player, variant, 0, &cache, [&second](const Board &b) { second.push_back(b); });
+        EXPECT_EQ(cache.size(), entries) << "variant of board " << i << " missed the cache";
+        ASSERT_EQ(second.size(), 1u);
+        EXPECT_EQ(second, sortedSolutions(player.solveSudoku(variant)));
+    }
+}
+
+// 单线程依次求解（与-j 1相同），每个棋盘最多limit个解
+std::vector<std::vector<Board> > solveSequential(const std::vector<Board> &boards, int limit, SolutionCache *cache)
+{
+    SudokuPlayer player;
+    std::vector<std::vector<Board> > results(boards.size());
+    for (size_t i = 0; i < boards.size(); i++)
+    {
+        std::vector<Board> &out = results[i];
+        solveCached(player, boards[i], limit, cache, [&out](const Board &b) { out.push_back(b); });
+    }
+    return results;
+}
+
+// 多线程批量求解的结果（包括解的顺序）与单线程完全相同：拆分子树、限制解的数量、批次内有等价题目并使用缓存
+TEST(BatchSolverTest, SameOutputAsSingleThread)
+{
+    std::vector<Board> corpus = testCorpus();
+    Pcg32 rng;
+    rng.seed(24, 1);
+    for (size_t i = 0, n = corpus.size(); i < n; i += 3)
+    {
+        corpus.push_back(randomTransform(rng).apply(corpus[i]));
+    }
+    // 解的数量不超过MAX_SOLUTIONS的多解题目之后紧跟它的等价变换：单线程求解时后者的解来自缓存，顺序与直接搜索不同
+    const char *multiple[] = {
+        ".974.83.18.2..3.9.3.1..5...7...8.13.2841.6.5.1...59....7....6.3.2.3........597.2.",
+        ".9.46......82..4....7..8.9.....4.8..81.52.7.67...135.9..2.74..1..1...6...74...9.2",
+    };
+    for (size_t i = 0; i < sizeof(multiple) / sizeof(multiple[0]); i++)
+    {
+        corpus.push_back(parseLine(multiple[i]));
+        corpus.push_back(randomTransform(rng).apply(corpus.back()));
+    }
+    // 只有19个数字的题目：解很多，但找到第一个解需要约38000个节点，会被拆分为许多子树
+    std::vector<Board> sparse = corpus;
+    sparse.push_back(parseLine(".....62...59.....82....8.9..45........3........6..3.54...325..6.................."));
+    sparse.push_back(randomTransform(rng).apply(sparse.back()));
+    const int limits[] = {0, 1, 3, 20};
+    for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++)
+    {
+        int limit = limits[l];
+        const std::vector<Board> &boards = limit == 0 ? corpus : sparse;
+        std::vector<std::vector<Board> > expected = solveSequential(boards, limit, NULL);
+        SolutionCache cache;
+        std::vector<std::vector<Board> > expectedCached = solveSequential(boards, limit, &cache);
+        for (int threads = 2; threads <= 4; threads++)
+        {
+            EXPECT_EQ(solveBatch(boards, threads, ENGINE_DFS, limit), expected) << "limit " << limit << ", threads " << threads;
+            SolutionCache batchCache;
+            EXPECT_EQ(solveBatch(boards, threads, ENGINE_DFS, limit, NULL, &batchCache), expectedCached)
+                << "limit " << limit << ", threads " << threads << ", cache";
+            EXPECT_EQ(batchCache.size(), cache.size());
+        }
+    }
+}
+
+// 逐格计算候选数字集合：空格为所在行、列、块中都未出现的数字，已填格子为0
+std::vector<uint16_t> scalarCandidates(const Board &board)
+{
+    std::vector<uint16_t> result(N * N, 0);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            if ('1' <= board[i][j] && board[i][j] <= '9')
+            {
+                continue;
+            }
+            uint16_t used = 0;
+            for (int k = 0; k < N; k++)
+            {
+                int bi = i / 3 * 3 + k / 3, bj = j / 3 * 3 + k % 3;
+                const char seen[] = {board[i][k], board[k][j], board[bi][bj]};
+                for (int t = 0; t < 3; t++)
+                {
+                    if ('1' <= seen[t] && seen[t] <= '9')
+                    {
+                        used |= 1 << (seen[t] - '1');
+                    }
+                }
+            }
+            result[i * N + j] = ~used & 0x1FF;
+        }
+    }
+    return result;
+}
+
+// 批量校验的结果与逐个校验一致；数量不是向量宽度整数倍时最后一组只有部分通道有效
+TEST(CheckBoardsTest, SameAsScalar)
+{
+    SudokuPlayer player;
+    player.seed(12);
+    Pcg32 rng;
+    rng.seed(12, 1);
+    std::vector<Board> boards;
+    for (int k = 0; k < 40; k++)
+    {
+        Board board = player.generateBoard(rng.below(60));
+        if (k % 2 == 1) // 把某个已填的数字复制到同一行的另一格，使棋盘非法
+        {
+            int i, j, other;
+            do
+            {
+                i = rng.below(N);
+                j = rng.below(N);
+            } while (board[i][j] == '$');
+            do
+            {
+                other = rng.below(N);
+            } while (other == j);
+            board[i][other] = board[i][j];
+        }
+        if (k % 5 == 0) // 也用'.'表示空格
+        {
+            std::replace(board.cells, board.cells + N * N, '$', '.');
+        }
+        boards.push_back(board);
+    }
+    const size_t sizes[] = {1, 7, 8, 15, 16, 17, 33, 40};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        size_t count = sizes[s];
+        std::unique_ptr<bool[]> valid(new bool[count]);
+        std::vector<uint16_t> candidates(count * N * N, 0xFFFF);
+        checkBoards(boards.data(), count, valid.get(), candidates.data());
+        for (size_t k = 0; k < count; k++)
+        {
+            EXPECT_EQ(valid[k], player.checkBoard(boards[k])) << "count " << count << ", board " << k;
+            EXPECT_EQ(valid[k], k % 2 == 0) << "count " << count << ", board " << k;
+            std::vector<uint16_t> expected = scalarCandidates(boards[k]);
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), candidates.begin() + k * N * N))
+                << "count " << count << ", board " << k;
+        }
+    }
+}
+
+// 只需隐性唯一数、需要唯一候选数、需要试填的题目分别得到预期的最难技巧和难度分
+TEST(SudokuGraderTest, TechniqueAndScore)
+{
+    struct Case
+    {
+        const char *puzzle;
+        Technique hardest;
+        int score;
+    };
+    const Case cases[] = {
+        {"75368.21921975368468.219753537.4619.1.2.37..6846.92537.7.468..19..37.46846..2..75", TECH_HIDDEN_SINGLE, 20},
+        {"....9.2.7..9.67..3726...5....194...29.56...3.....3..4.18.......59....31...7..8..9", TECH_NAKED_SINGLE, 55},
+        {"9..7...1..7561...98....9.....2.4.1..54...6....86.9...72..4..8...5..6..2......347.", TECH_GUESS, 115},
+    };
+    SudokuGrader grader;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        Grade g = grader.grade(parseLine(cases[i].puzzle));
+        EXPECT_TRUE(g.valid) << "puzzle " << i;
+        EXPECT_EQ(g.hardest, cases[i].hardest) << "puzzle " << i;
+        EXPECT_EQ(g.score, cases[i].score) << "puzzle " << i;
+        int score = 0;
+        for (int t = 0; t < TECH_COUNT; t++)
+        {
+            score += g.steps[t] * TECHNIQUE_SCORES[t];
+        }
+        EXPECT_EQ(score, g.score) << "puzzle " << i;
+    }
+}
+
+// 已填数字冲突，以及数字1和2在第一行、第一块中都只能填在左上角的题目，都应评估为无效
+TEST(SudokuGraderTest, Contradiction)
+{
+    SudokuGrader grader;
+    EXPECT_FALSE(grader.grade(parseLine("11...............................................................................")).valid);
+    EXPECT_FALSE(grader.grade(parseLine(".............1.2.....2...1..1........2..................1........2...............")).valid);
+    // 发现矛盾后同一个grader仍可继续评估其他棋盘
+    Grade g = grader.grade(parseLine("75368.21921975368468.219753537.4619.1.2.37..6846.92537.7.468..19..37.46846..2..75"));
+    EXPECT_TRUE(g.valid);
+    EXPECT_EQ(g.score, 20);
+}
+
+// 超过读取缓冲区的请求只得到一个错误响应，其后的请求照常处理
+TEST(SudokuServerTest, RequestTooLong)
+{
+    FILE *in = tmpfile();
+    ASSERT_TRUE(in != NULL);
+    fprintf(in, "grade %s\n", std::string(100000, '1').c_str());
+    fprintf(in, "grade 53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79\n");
+    rewind(in);
+    SudokuServer server(ENGINE_DFS, 0, 1, 0, NULL);
+    std::vector<std::string> responses;
+    server.serve(in, [&responses](const std::string &response)
+                 {
+                     responses.push_back(response);
+                     return true;
+                 });
+    fclose(in);
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_EQ(responses[0], "err request too long\n");
+    EXPECT_EQ(responses[1].compare(0, 3, "ok "), 0);
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
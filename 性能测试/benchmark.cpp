@@ -0,0 +1,187 @@
+// 求解与生成热点路径的性能测试
+// 编译：g++ -std=c++11 -O2 -pthread -o benchmark benchmark.cpp
+// 运行：./benchmark [每项最短测试时间（秒），默认1]
+// 所有测试棋盘都由固定的随机数种子生成，不同版本之间的结果可以直接对比
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define SUDOKU_NO_MAIN
+#include "../code/sudoku.cpp"
+
+static const uint64_t CORPUS_SEED = 20230629;
+static double minSeconds = 1.0;
+static volatile size_t sink; // 防止被测代码被编译器优化掉
+
+// 几个公认的高难度题目
+static const char *FAMOUS_HARD[] = {
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    ".......39.....1..5..3.5.8....8.9...6.7...2..1..4.......9.8..5..2....6..4..7.....",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+};
+
+Board parseLine(const char *line)
+{
+    Board board;
+    for (int k = 0; k < N * N; k++)
+    {
+        board.cells[k] = line[k] == '.' ? '$' : line[k];
+    }
+    return board;
+}
+
+// 反复执行body直到总时间不少于minSeconds，每次执行处理boardsPerRun个棋盘
+template <class F>
+void run(const char *name, size_t boardsPerRun, F body)
+{
+    typedef chrono::steady_clock Clock;
+    size_t runs = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do
+    {
+        body();
+        runs++;
+        elapsed = chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    double boards = (double)boardsPerRun * runs;
+    printf("%-28s %12.0f %14.1f %14.0f\n", name, boards, elapsed * 1e9 / boards, boards / elapsed);
+}
+
+template <class Solver>
+void benchSolve(const char *name, const vector<Board> &corpus, int limit = 0)
+{
+    Solver solver;
+    run(name, corpus.size(), [&]()
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < corpus.size(); i++)
+            {
+                total += solver.solveSudoku(corpus[i], [](const Board &) {}, limit);
+            }
+            sink = total;
+        });
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        minSeconds = atof(argv[1]);
+    }
+
+    SudokuPlayer player;
+    player.seed(CORPUS_SEED);
+    SudokuGrader grader;
+
+    // 简单题：挖去20~30格；困难题：公认难题加上需要猜测才能解出的生成题；
+    // 多解题：挖去55格后再随机挖去8格，每题最多枚举100个解
+    vector<Board> easy, hard, multi;
+    for (int i = 0; i < 2000; i++)
+    {
+        easy.push_back(player.generateBoard(20 + player.randInt(11)));
+    }
+    for (size_t i = 0; i < sizeof(FAMOUS_HARD) / sizeof(FAMOUS_HARD[0]); i++)
+    {
+        hard.push_back(parseLine(FAMOUS_HARD[i]));
+    }
+    for (int i = 0; i < 200; i++)
+    {
+        hard.push_back(generateGradedBoard(55, TECHNIQUE_SCORES[TECH_GUESS], player, grader));
+    }
+    for (int i = 0; i < 200; i++)
+    {
+        Board board = player.generateBoard(55);
+        for (int k = 0; k < 8;)
+        {
+            int cell = player.randInt(N * N);
+            if (board.cells[cell] != '$')
+            {
+                board.cells[cell] = '$';
+                k++;
+            }
+        }
+        multi.push_back(board);
+    }
+    vector<Board> complete;
+    for (int i = 0; i < 2000; i++)
+    {
+        complete.push_back(player.generateBoard(0));
+    }
+
+    printf("%-28s %12s %14s %14s\n", "benchmark", "boards", "ns/board", "boards/s");
+
+    benchSolve<SudokuPlayer>("solve/dfs/easy", easy);
+    benchSolve<SudokuPlayer>("solve/dfs/hard", hard);
+    benchSolve<SudokuPlayer>("solve/dfs/multi(<=100)", multi, 100);
+    benchSolve<DlxSolver>("solve/dlx/easy", easy);
+    benchSolve<DlxSolver>("solve/dlx/hard", hard);
+    benchSolve<DlxSolver>("solve/dlx/multi(<=100)", multi, 100);
+
+    static const int LEVELS[3][2] = {{20, 30}, {30, 40}, {40, 55}};
+    for (int level = 0; level < 3; level++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "generate/level%d", level + 1);
+        run(name, 100, [&]()
+            {
+                for (int i = 0; i < 100; i++)
+                {
+                    int cnt = LEVELS[level][0] + player.randInt(LEVELS[level][1] - LEVELS[level][0] + 1);
+                    sink = player.generateBoard(cnt).cells[0];
+                }
+            });
+    }
+    run("generate/unique/level3", 100, [&]()
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                sink = generateUniqueBoard(40 + player.randInt(16), player).cells[0];
+            }
+        });
+
+    run("check/checkBoard", complete.size(), [&]()
+        {
+            size_t ok = 0;
+            for (size_t i = 0; i < complete.size(); i++)
+            {
+                ok += player.checkBoard(complete[i]);
+            }
+            sink = ok;
+        });
+    unique_ptr<bool[]> valid(new bool[complete.size()]);
+    run("check/checkBoards", complete.size(), [&]()
+        {
+            checkBoards(complete.data(), complete.size(), valid.get());
+            sink = valid[0];
+        });
+
+    // 文件读写：分别测试文本格式和二进制格式
+    const char *textFile = "benchmark_boards.txt";
+    const char *binaryFile = "benchmark_boards.bin";
+    run("io/writeFile(text)", complete.size(), [&]()
+        {
+            ofstream out(textFile, ios::out | ios::trunc);
+            writeFile(complete, out);
+        });
+    run("io/readFile(text)", complete.size(), [&]()
+        {
+            sink = readFile(textFile).size();
+        });
+    run("io/write(bin)", complete.size(), [&]()
+        {
+            ofstream out(binaryFile, ios::out | ios::trunc | ios::binary);
+            BoardWriter writer(out, FORMAT_BINARY);
+            writer.write(complete);
+        });
+    run("io/read(bin)", complete.size(), [&]()
+        {
+            sink = readFile(binaryFile).size();
+        });
+    remove(textFile);
+    remove(binaryFile);
+    return 0;
+}